@@ -1,56 +1,965 @@
 #include <stdio.h>
 #include <stdlib.h>
+#include <string.h>
+#include <math.h>
 #include <time.h>
 #include <unistd.h>
+#include <pthread.h>
 
 #define WEAPON 34
+#define COLUMNS 8
+#define STATS 7
+#define TERMS 8
+#define PAGE 20
+#define TIERS 5
+#define STREAKS 5
+#define LEAD 5
+#define FORMULAS 2
+#define ECONOMIES 3
+#define TEAM 5
+#define LINE 64
+#define RING (1 << 16)
+#define INDEXSTEP 1024
 
-double balanced[WEAPON];
+double *balanced;
 
+//Interned weapon names, kept apart from the columns scoring and simulation read.
+//Row j's name is text + off[j], len[j] bytes long and 0 terminated.
+struct nameS{
+    char *text;
+    int used;
+    int size;
+    int *off;
+    int *len;
+    //Open addressing over distinct names, offset + 1 of each, 0 when empty
+    int *slot;
+    int slots;
+    int names;
+};
+
+//Numeric columns, every one aligned to a cache line
 struct casE{
-    char name[WEAPON][WEAPON];
-    int price[WEAPON];
-    int damage[WEAPON];
-    float firerate[WEAPON];
-    int magazine[WEAPON];
-    int falloff[WEAPON];
-    float range[WEAPON];
-    float recoil[WEAPON];
+    int *price;
+    int *damage;
+    float *firerate;
+    int *magazine;
+    int *falloff;
+    float *range;
+    float *recoil;
+    //Sides that may buy the row, 1 T, 2 CT, 3 both
+    int *side;
+    //Buying tier of the row, TIERS for none, and the rows of every tier in catalog order
+    int *tier;
+    int *tierrow[TIERS];
+    int tierrows[TIERS];
+    int count;
+    int cap;
+    struct nameS names;
 };
 
 struct casE ammo;
 
+//Optional token of a catalog line, index + 1 is the side mask
+const char *sidename[3] = {"T", "CT", "any"};
+
+//Balance score formulas, classic is the one play() has always used
+const char *formulas[FORMULAS] = {"classic", "dps"};
+
+//Arithmetic of the balance score: float as play() has always scored, or fixed point
+//with the same value on every compiler and CPU
+const char *scorings[2] = {"float", "fixed"};
+int scoring;
+
+//Columns the about view can sort and filter by
+const char *columns[COLUMNS] = {"price", "damage", "firerate", "magazine", "falloff", "range", "recoil", "balance"};
+
+//Ascending permutation index of every column, rebuilt on each catalog load
+int *order[COLUMNS];
+
+//One "column op value" term of an about() filter
+struct filteR{
+    int col;
+    int op;
+    double value;
+};
+
+//A buying tier of play(): its catalog rows plus a price index for budget queries
+struct tieR{
+    const char *name;
+    int *idx;
+    int count;
+    int *byprice;
+    int *price;
+    int *best;
+    //One bitset of tier-local rows per distinct price, bit k stands for idx[k]
+    int breaks;
+    int words;
+    int *brk;
+    unsigned long long *afford;
+};
+
+//splitmix64 stream, cheap enough to give every simulated match its own.
+//A flip of all ones turns it into the antithetic twin of the same seed.
+struct rnG{
+    unsigned long long s;
+    unsigned long long flip;
+};
+
+//Walker/Vose alias table for O(1) weighted picks over the rows of a tier
+struct aliaS{
+    int n;
+    double *prob;
+    int *alias;
+    double *weight;
+};
+
+//Catalog tier tokens. Lines without one keep the old positions: rows 0-9 pistols,
+//10-16 SMGs, 17-22 heavy, 23-29 rifles, 30-33 snipers.
+const char *tiername[TIERS] = {"pistol", "smg", "heavy", "rifle", "sniper"};
+const int slice[TIERS][2] = {{0, 10}, {10, 7}, {17, 6}, {23, 7}, {30, 4}};
+//Income of the built-in schedule, one round per tier
+const int income[TIERS] = {900, 1700, 2000, 2600, 3500};
+
+//A match as compiled from a schedule file: round r draws its weapons from pool draw[r]
+//and pays pay[r], a pool being a set of tiers with bit k for tiername[k]. The match is
+//over once a side has won firstto rounds, 0 plays every round.
+struct scheD{
+    int rounds;
+    int firstto;
+    int *draw;
+    int *pay;
+    int pools;
+    int *mask;
+    char (*name)[64];
+    int builtin;
+};
+
+//schedule.txt when it exists, else one round per tier
+struct scheD sched;
+
+//Money rules of a match, applied to both sides alike. Each round pays income percent of
+//its scheduled income; the winner earns win plus the kill reward of its weapon's tier and the
+//loser the bonus of its losing streak (the last one repeats). Before the next income
+//only carry percent of the unspent money is kept, and a cap above 0 bounds the balance.
+struct ecoN{
+    const char *name;
+    int income;
+    int start;
+    int win;
+    int loss[STREAKS];
+    int kill[TIERS];
+    int carry;
+    int cap;
+};
+
+//Classic is the income schedule play() has always used
+const struct ecoN economies[ECONOMIES] = {
+    {"classic", 100, 0, 0, {0, 0, 0, 0, 0}, {0, 0, 0, 0, 0}, 100, 0},
+    {"cs", 0, 800, 3250, {1400, 1900, 2400, 2900, 3400}, {300, 600, 900, 300, 100}, 100, 16000},
+    {"reset", 100, 0, 0, {0, 0, 0, 0, 0}, {0, 0, 0, 0, 0}, 0, 0},
+};
+
+//Everything the headless engine reads: one loaded catalog with its scores and tiers
+struct gamE{
+    struct casE *cat;
+    double *score;
+    //Every row of a tier, whichever side may buy it
+    struct tieR tier[TIERS];
+    //The schedule's rounds, copied from sched when the game is built
+    int rounds;
+    int firstto;
+    int pools;
+    const int *draw;
+    const int *pay;
+    //Per pool, its rows for either side, then the rows each side may buy (T, CT),
+    //and the side every seat of a match plays
+    struct tieR *pool;
+    struct tieR *sides[2];
+    int seat[2];
+    //Per pool, T rows against CT rows: matchup[p][k * CT count + l] is 1 if T row k
+    //scores higher than CT row l, -1 if lower and 0 on a tie
+    signed char **matchup;
+    //Per side and pool, weights proportional to how much of the other side's pool each row beats
+    struct aliaS *share[2];
+    const struct ecoN *eco;
+    //Kill reward of every catalog row, index count stands for buying nothing
+    int *kill;
+};
+
+struct gamE game;
+
+//Price-efficiency frontiers and the buy plan of one catalog version. The plan maximises
+//the expected rounds won against a uniform pick of each tier under the cumulative
+//balance, by dynamic programming over balances in multiples of unit. It only counts
+//money the economy is sure to pay, so a plan never needs a round to be won.
+struct plaN{
+    unsigned long long hash;
+    int valid;
+    int pools;
+    int **front;
+    int *fronts;
+    int rounds;
+    int unit;
+    int states;
+    double *value;
+    int *choice;
+};
+
+//Per side, cached for the catalog version it was computed from
+struct plaN plan[2];
+
+//Compact catalog: every stat is a narrow unsigned integer q standing for
+//q / 2^shift[c], c in columns[] order. Counts fit a byte, the rest 16 bits. Only parity
+//reads it; the engine keeps running on the full-width columns.
+struct quanT{
+    unsigned short *price;
+    unsigned char *damage;
+    unsigned short *firerate;
+    unsigned char *magazine;
+    unsigned char *falloff;
+    unsigned short *range;
+    unsigned short *recoil;
+    int shift[STATS];
+    int count;
+};
+
+//Bytes of a quantized stat, in columns[] order
+const int statbytes[STATS] = {2, 1, 2, 1, 1, 2, 2};
+
+//Relative balance score error the quantized catalog may have, 2^-10
+#define TOLERANCE (1.0 / 1024)
+
+//Matches replayed on the float and quantized games with the same streams
+struct paritY{
+    const struct gamE *g[2];
+    const struct boT *a;
+    const struct boT *b;
+    long long matches;
+    unsigned long long seed;
+    pthread_mutex_t lock;
+    long long next;
+    long long flips;
+    long long wins[2];
+};
+
+//Compact match state, both sides ready to buy for the round it names
+struct matcH{
+    int round;
+    int blnc[2];
+    int score[2];
+    int streak[2];
+};
+
+//5v5 match state: every player keeps their own balance, while round rewards and the
+//loss bonus streak belong to the side
+struct teaM{
+    int round;
+    int blnc[2][TEAM];
+    int score[2];
+    int streak[2];
+};
+
+//What a bot sees when it has to buy, from its own side of the table
+struct rounD{
+    const struct gamE *g;
+    const struct tieR *t;
+    int side;
+    int round;
+    int balance;
+    int opponent;
+    int won;
+    int lost;
+    int losses;
+    int opplosses;
+};
+
+//A bot is a pick function plus read-only data shared by every match it plays.
+//Picks return a catalog row of r->t or -1 to buy nothing; anything a bot needs per
+//match must come from its arguments so matches can run side by side.
+struct boT{
+    const char *name;
+    int (*pick)(const struct boT *bot, const struct rounD *r, struct rnG *rng);
+    const void *ctx;
+};
+
+int randombot(const struct boT *bot, const struct rounD *r, struct rnG *rng);
+int greedybot(const struct boT *bot, const struct rounD *r, struct rnG *rng);
+int ecobot(const struct boT *bot, const struct rounD *r, struct rnG *rng);
+int equilibriumbot(const struct boT *bot, const struct rounD *r, struct rnG *rng);
+int mctsbot(const struct boT *bot, const struct rounD *r, struct rnG *rng);
+int qbot(const struct boT *bot, const struct rounD *r, struct rnG *rng);
+
+//Search budget of the mcts bot per decision
+struct mctS{
+    int playouts;
+    int ms;
+};
+
+struct mctS mctsconf = {100000, 50};
+
+//Threads of the parallel modes, 0 means every core
+int workers = 0;
+
+//Set on the worker threads of a parallel mode: they already fill the cores, so a bot
+//called there must not start threads of its own
+_Thread_local int pooled;
+
+//Bump allocator of one thread for what a match allocates. Nothing in it is freed on its
+//own: a match hands back what it took when it ends, and sim empties it after every
+//batch. A request past the block starts a bigger one, older blocks are freed at the next reset.
+struct arenA{
+    char *base;
+    size_t used;
+    size_t cap;
+    size_t peak;
+    //Bytes handed out since the last reset, and the most of that at one time
+    size_t live;
+    size_t top;
+};
+
+_Thread_local struct arenA arena;
+
+//Largest peak of the threads that have exited, their blocks go with them
+size_t arenapeak;
+pthread_mutex_t arenalock = PTHREAD_MUTEX_INITIALIZER;
+pthread_key_t arenakey;
+pthread_once_t arenaonce = PTHREAD_ONCE_INIT;
+
+//Open-loop search node: in the classic economy a side's balance only depends on its own
+//buys, so a path of own picks fixes the legal moves below it while opponent picks are
+//sampled per playout
+struct nodE{
+    int action;
+    int first;
+    int count;
+    int visits;
+    double wins;
+};
+
+//One search thread of an mcts decision, all threads start from the same snapshot
+struct mctsjoB{
+    const struct gamE *g;
+    struct matcH root;
+    int side;
+    int playouts;
+    double deadline;
+    unsigned long long seed;
+    int *visits;
+};
+
+//Dense action values of the learned bot, indexed [side][round][bucket][lead][action]
+//with rounds counting both sides and the score lead clamped to LEAD. Action 0 buys nothing, action k + 1 buys row k of the
+//side's tier in the round.
+struct qtablE{
+    int rounds;
+    int buckets;
+    int bucket;
+    int scores;
+    int actions;
+    unsigned long long hash;
+    float *q;
+};
+
+//Loaded from policy.bin at startup when the file exists
+struct qtablE policy;
+
+//One training thread: its own replica of the table and its own episodes
+struct trainjoB{
+    const struct gamE *g;
+    const struct boT *opponent;
+    struct qtablE qt;
+    long long episodes;
+    double epsilon;
+    double alpha;
+    unsigned long long seed;
+};
+
+//One round-robin pairing of the league, points are bot a's with draws counting half
+struct paiR{
+    int a;
+    int b;
+    long long games;
+    double points;
+    int busy;
+    int done;
+};
+
+#define BOTS 6
+
+//Rounds each catalog row was bought in and won, filled by simmatch() when given
+struct tallY{
+    long long *picked;
+    long long *won;
+};
+
+//Paired A/B run: match i of both variants replays the same random streams
+struct pairjoB{
+    const struct gamE *g[2];
+    const struct boT *a;
+    const struct boT *b;
+    long long pairs;
+    int batch;
+    int antithetic;
+    unsigned long long seed;
+    pthread_mutex_t lock;
+    long long next;
+    double sum[2];
+    double sq[2];
+    double dsum;
+    double dsq;
+};
+
+//Evaluator of candidate price lists for the rebalancer. Every candidate replays the
+//same opponent streams under the game's economy and side pools. The matches of the
+//current price list are kept with a trail of their rounds, so a candidate that moves
+//one row only replays the matches whose buys could see that row's price.
+struct tunE{
+    const struct gamE *g;
+    const int *base;
+    int samples;
+    unsigned long long seed;
+    //Per side, slot[s][p * (count + 1) + j] is the position of row j in that side's pool p, -1 if absent
+    int *slot[2];
+    //Prices the cache was played at, then per row and sample the match result and per
+    //round both balances before buying and both buys, -1 for rounds not played
+    int *price;
+    unsigned char *won;
+    int *trail;
+};
+
+//A batch of candidate price lists scored in parallel
+struct candjoB{
+    const struct tunE *tn;
+    int n;
+    int **price;
+    double *cost;
+    pthread_mutex_t lock;
+    int next;
+};
+
+//One column override of a catalog variant, columns numbered as in about()
+struct overridE{
+    int variant;
+    int row;
+    int col;
+    double value;
+};
+
+//Catalog variants with the variant as the innermost dimension: row j of variant v
+//lives at [j * variants + v], so the scoring and win-rate kernels run across variants
+struct batcH{
+    int rows;
+    int variants;
+    float *damage;
+    float *firerate;
+    float *magazine;
+    float *falloff;
+    float *range;
+    float *recoil;
+    float *score;
+    float *rate;
+    //With --scoring fixed the variants are ranked on fixedscore(), NULL otherwise
+    long long *fixed;
+    const struct gamE *g;
+    pthread_mutex_t lock;
+    int next;
+};
+
+//Sensitivity of one weapon to one stat: analytic elasticity of the balance score and
+//finite-difference elasticity of its round win rate from paired simulations
+struct sensE{
+    int row;
+    int col;
+    double elastic;
+    double winrate;
+    double slope;
+};
+
+//Shared state of a sensitivity run, jobs are (row, stat) pairs
+struct sensjoB{
+    const struct gamE *g;
+    const struct boT *a;
+    const struct boT *b;
+    long long matches;
+    unsigned long long seed;
+    struct sensE *out;
+    int n;
+    //Unperturbed round win rate of every row, one run of the loaded game fills it
+    double *base;
+    pthread_mutex_t lock;
+    int next;
+};
+
+//Threaded simulation run: batches are handed out under lock, and every worker
+//merges its batch and checks the stopping rules before taking the next one
+struct simjoB{
+    const struct gamE *g;
+    const struct boT *a;
+    const struct boT *b;
+    long long matches;
+    int batch;
+    double precision;
+    double alpha;
+    unsigned long long seed;
+    pthread_mutex_t lock;
+    long long next;
+    long long played;
+    long long won[3];
+    int looks;
+    int stop;
+    int team;
+    struct tallY tally;
+    //With --record, batches are appended in id order, flushed is the next one due
+    struct replaY *record;
+    long long flushed;
+    pthread_cond_t order;
+};
+
+//Replay log: a header, one record per match, then the sparse index and a trailer.
+//Header: "FSRP", version, players per side, varint batch, seed and catalog hash as
+//little-endian 64-bit words, and the two bot names each after a length byte.
+//Match: varint length of the rest, varint players, varint side of seat 0, then per
+//round every player's varint pick + 1 and zigzag varint balance change since their
+//previous round, seat 0's players first, and a varint outcome: the winning seat, or 2
+//for a round nobody could buy in.
+//Index: varint count, then the varint offset step to every INDEXSTEP-th match.
+//Trailer: match count and index offset as 64-bit words, then "FSRX".
+struct replaY{
+    FILE *file;
+    unsigned char *ring;
+    size_t head;
+    size_t tail;
+    long long offset;
+    long long matches;
+    long long *index;
+    int indexes;
+};
+
+//One match being encoded into a caller's buffer of tapebound() bytes
+struct tapE{
+    unsigned char *buf;
+    size_t used;
+    int players;
+    int last[2 * TEAM];
+};
+
+//Reading side of a replay log
+struct readeR{
+    FILE *file;
+    int players;
+    int batch;
+    unsigned long long seed;
+    unsigned long long hash;
+    char bot[2][32];
+    long long matches;
+    long long *index;
+    int indexes;
+    long long data, stop;
+    long long next;
+    unsigned char *body;
+    size_t cap;
+};
+
+//A decoded match, per round and player with seat 0's players first
+struct recorD{
+    int players;
+    int side;
+    int rounds;
+    int *pick;
+    int *blnc;
+    int *win;
+    int cap;
+};
+
+//Verification of a log: segments are the spans between index entries, handed out to
+//the workers in order. Everything below lock is guarded by it.
+#define SHOWN 10
+struct verifY{
+    const struct gamE *g;
+    const char *file;
+    const struct readeR *log;
+    int segments;
+    pthread_mutex_t lock;
+    int next;
+    long long checked, changed, rounds, flipped, dropped, broke, skipped;
+    int shown;
+    long long match[SHOWN];
+    int was[SHOWN][2], now[SHOWN][2];
+};
+
+//Matches of a simulated batch played in lockstep, one lane each. Bots still pick lane
+//by lane, but outcomes and money of a round are settled for all lanes at once.
+struct lanE{
+    int n;
+    int round;
+    int *pick[2];
+    int *win;
+    int *live;
+    int *cost[2];
+    int *gain[2];
+    int *bonus[2];
+    int *blnc[2];
+    int *streak[2];
+    int *score[2];
+    struct rnG *seat[2];
+};
+
+//League state shared by the workers, everything below lock is guarded by it
+struct leaguE{
+    int n;
+    const struct boT *bot[BOTS];
+    long long maxgames;
+    int batch;
+    double elo;
+    const char *file;
+    pthread_mutex_t lock;
+    double rating[BOTS];
+    int pairs;
+    struct paiR pair[BOTS * BOTS];
+    unsigned long long seed;
+};
+
+struct boT bots[BOTS] = {
+    {"random", randombot, NULL},
+    {"greedy", greedybot, NULL},
+    {"eco", ecobot, NULL},
+    {"equilibrium", equilibriumbot, NULL},
+    {"mcts", mctsbot, &mctsconf},
+    {"qlearn", qbot, &policy},
+};
+
+//Opponent of the interactive game, changed from Options
+const struct boT *enemybot = &bots[0];
+
+int command(int argc, char *argv[]);
+int setup(const char *file);
 void gamemenu();
+void options();
 void play(struct casE *ptr);
 void about(struct casE *ptr, int count);
+int loadcase(struct casE *ptr, const char *file);
+int regrow(void *col, size_t used, size_t size);
+void clearnames(struct nameS *n);
+int intern(struct nameS *n, const char *s);
+void score(struct casE *ptr, int formula, double *out);
+long long fixedscore(int damage, float firerate, int magazine, int falloff, float range, float recoil, int formula);
+double column(struct casE *ptr, int c, int j);
+void radixsort(unsigned long long *key, int *perm, int n);
+void buildorder(struct casE *ptr);
+int parsefilter(const char *s, struct filteR *term);
+void readline(char *buf, int n);
+void buildtier(struct casE *ptr, const double *score, int sides, int mask, struct tieR *t);
+void indexcase(struct casE *ptr);
+int findtier(const char *name);
+int addpool(struct scheD *s, int mask);
+void addround(struct scheD *s, int pool, int pay);
+void freeschedule(struct scheD *s);
+void defaultschedule(struct scheD *s);
+int loadschedule(struct scheD *s, const char *file);
+const struct tieR *roundtier(const struct gamE *g, int round);
+int bestbuy(const struct tieR *t, int budget);
+int breakpoint(const struct tieR *t, int budget);
+int canafford(const struct tieR *t, int k, int budget);
+int affordcount(const struct tieR *t, int budget);
+int affordpick(const struct tieR *t, int budget, struct rnG *rng);
+unsigned long long rnd(struct rnG *rng);
+int rndint(struct rnG *rng, int n);
+void buildalias(struct aliaS *a, const double *w, int n);
+int setweights(struct aliaS *a, const double *w, int n);
+int aliaspick(const struct aliaS *a, struct rnG *rng);
+int weightedpick(const struct tieR *t, const struct aliaS *a, int budget, struct rnG *rng);
+unsigned long long orderkey(double v);
+void buildgame(struct gamE *g);
+const char *wname(const struct casE *ptr, int j);
+const struct boT *findbot(const char *name);
+void newmatch(const struct gamE *g, struct matcH *m);
+void botview(const struct gamE *g, const struct matcH *m, int side, struct rounD *r);
+int resolve(const struct gamE *g, struct matcH *m, int a, int b);
+int simmatch(const struct gamE *g, const struct boT *a, const struct boT *b, struct rnG *rng, struct tallY *tally);
+int roundincome(const struct gamE *g, int round);
+const struct tieR *seattier(const struct gamE *g, int seat, int round);
+int findside(const char *name);
+void seteconomy(struct gamE *g, const struct ecoN *e);
+const struct ecoN *findeconomy(const char *name);
+int textflag(int *argc, char *argv[], const char *name, const char **value);
+int newlanes(struct lanE *l, int cap);
+void startlanes(const struct gamE *g, struct lanE *l, int n, struct rnG *rng);
+void laneview(const struct gamE *g, const struct lanE *l, int i, int side, struct rounD *r);
+void settle(const struct gamE *g, struct lanE *l);
+int plannext(const struct gamE *g, int round, int balance);
+void teamplay(struct casE *ptr);
+int askweapon(const struct tieR *t, int budget);
+void newteam(const struct gamE *g, struct teaM *m);
+void teamview(const struct gamE *g, const struct teaM *m, int side, int player, struct rounD *r);
+void duels(const struct gamE *g, int n, const int *a, const int *b, unsigned long long coin, int *win);
+int teamround(const struct gamE *g, struct teaM *m, int buy[2][TEAM], struct rnG *rng, int kills[2][TEAM]);
+int teammatch(const struct gamE *g, const struct boT *a, const struct boT *b, struct rnG *rng, struct tallY *tally, struct tapE *tape);
+size_t putvarint(unsigned char *p, unsigned long long v);
+unsigned long long getvarint(const unsigned char **p, const unsigned char *end);
+int filevarint(FILE *f, unsigned long long *v);
+size_t tapebound(int players, int rounds);
+void tapebegin(struct tapE *t, unsigned char *buf, int players, int side);
+void taperound(struct tapE *t, const int *pick, const int *blnc, int win);
+size_t tapeend(struct tapE *t);
+int replayopen(struct replaY *w, const char *file, int players, int batch, unsigned long long seed,
+               unsigned long long hash, const char *a, const char *b, int append);
+void replaybytes(struct replaY *w, const unsigned char *p, size_t n);
+void ringflush(struct replaY *w);
+void replaymatch(struct replaY *w, const unsigned char *p, size_t n);
+void replayclose(struct replaY *w);
+void logplay(struct tapE *t, int players, unsigned long long seed);
+int replayread(struct readeR *r, const char *file);
+int replayseek(struct readeR *r, long long n);
+int replaynext(struct readeR *r, struct recorD *m);
+void replayfree(struct readeR *r);
+int replay(int argc, char *argv[]);
+int rematch(const struct gamE *g, const struct recorD *m, struct rnG *wave, int now[2], int *flips, int *broke);
+void *verifyworker(void *arg);
+int verify(int argc, char *argv[]);
+int simulate(int argc, char *argv[]);
+void *abworker(void *arg);
+int abtest(int argc, char *argv[]);
+void buildtune(struct tunE *tn, const struct gamE *g, const int *base, int samples);
+int commitmatch(const struct tunE *tn, const int *price, int j, int s, int *trail);
+int touched(const struct tunE *tn, int j, int s, int m, int lo, int hi);
+int moverow(const struct tunE *tn, const int *price, int *lo, int *hi);
+void retune(struct tunE *tn, const int *price);
+double committed(const struct tunE *tn, const int *price, double *rate);
+void freetune(struct tunE *tn);
+void *candworker(void *arg);
+void scorebatch(const struct tunE *tn, int n, int **price, double *cost);
+int rebalance(int argc, char *argv[]);
+int savecase(const struct casE *ptr, const int *price, const char *file);
+void runworkers(void *(*fn)(void *), void *arg, int threads);
+void buildbatch(struct batcH *b, const struct gamE *g, int variants, const struct overridE *ov, int n);
+void *batchworker(void *arg);
+void evalbatch(struct batcH *b);
+void freebatch(struct batcH *b);
+int sweep(int argc, char *argv[]);
+void freegame(struct gamE *g);
+void freetier(struct tieR *t);
+double rowscore(const struct casE *ptr, int j, int col, double value);
+double weaponrate(const struct gamE *g, const struct sensjoB *job, int row, struct tallY *tally);
+void *sensworker(void *arg);
+int sensitivity(int argc, char *argv[]);
+int bylever(const void *a, const void *b);
+int gcd(int a, int b);
+const struct plaN *getplan(const struct gamE *g, int side);
+int planned(const struct plaN *p, int round, int balance);
+int planner(int argc, char *argv[]);
+int qshift(double max, int top);
+int quantize(const struct casE *ptr, struct quanT *q);
+double qvalue(const struct quanT *q, int c, int j);
+void dequantize(const struct quanT *q, const struct casE *ptr, struct casE *out);
+void qscore(const struct quanT *q, double *out);
+void freequant(struct quanT *q);
+void *parityworker(void *arg);
+int parity(int argc, char *argv[]);
+void *simworker(void *arg);
+double probit(double p);
+int flag(int *argc, char *argv[], const char *name, double *value);
+double now();
+int cores();
+int moves(const struct tieR *t, int budget, int *out);
+void *mctsworker(void *arg);
+void *mctsthread(void *arg);
+void *arenaalloc(struct arenA *a, size_t size);
+void arenarelease(struct arenA *a, const char *block, size_t used);
+void arenareset(struct arenA *a);
+void arenadone(void *arg);
+void arenakeys();
+size_t arenastat();
+unsigned long long cataloghash(const struct gamE *g);
+void newtable(const struct gamE *g, struct qtablE *qt);
+float *qrow(const struct qtablE *qt, const struct matcH *m, int side, int team);
+int qchoose(const struct tieR *t, const float *row, int budget, double epsilon, struct rnG *rng);
+void *trainworker(void *arg);
+int train(int argc, char *argv[]);
+int savepolicy(const struct qtablE *qt, const char *file);
+int loadpolicy(const struct gamE *g, struct qtablE *qt, const char *file);
+int seatmatch(const struct gamE *g, const struct boT *a, const struct boT *b, long long i, struct rnG *rng, struct tallY *tally);
+void wilson(double p, double n, double z, double *lo, double *hi);
+double elogap(double p);
+void *leagueworker(void *arg);
+void fitratings(struct leaguE *l);
+int league(int argc, char *argv[]);
+int saveleague(const struct leaguE *l);
+int loadleague(struct leaguE *l);
 
-int main(){
+int main(int argc, char *argv[]){
+
+    if (setup("case.txt") < 0) {
+        printf("case.txt could not be opened\n");
+        return 1;
+    }
+
+    if (argc > 1) {
+        return command(argc, argv);
+    }
 
     gamemenu();
 
     return 0;
 }
 
-void gamemenu(){
+//Headless modes, e.g. "ammo sim greedy random 100000"
+int command(int argc, char *argv[]){
 
-    struct casE *ptr = &ammo;
+    double v;
+    const char *name;
+    if (textflag(&argc, argv, "--scoring", &name)) {
+        scoring = strcmp(name, scorings[1]) == 0;
+        if (!scoring && strcmp(name, scorings[0]) != 0) {
+            printf("Unknown scoring %s\n", name);
+            return 1;
+        }
+        setup("case.txt");
+    }
+    if (flag(&argc, argv, "--playouts", &v)) mctsconf.playouts = (int)v;
+    if (flag(&argc, argv, "--ms", &v)) mctsconf.ms = (int)v;
+    if (flag(&argc, argv, "--threads", &v)) workers = (int)v;
+    if (textflag(&argc, argv, "--economy", &name)) {
+        if (findeconomy(name) == NULL) {
+            printf("Unknown economy %s\n", name);
+            return 1;
+        }
+        seteconomy(&game, findeconomy(name));
+        loadpolicy(&game, &policy, "policy.bin");
+    }
+    if (textflag(&argc, argv, "--schedule", &name)) {
+        if (loadschedule(&sched, name) < 0) {
+            printf("%s is not a valid schedule\n", name);
+            return 1;
+        }
+        buildgame(&game);
+        loadpolicy(&game, &policy, "policy.bin");
+    }
 
-    FILE *fptr;
+    if (strcmp(argv[1], "sim") == 0 || strcmp(argv[1], "team") == 0) {
+        return simulate(argc, argv);
+    }
+    if (strcmp(argv[1], "train") == 0) {
+        return train(argc, argv);
+    }
+    if (strcmp(argv[1], "league") == 0) {
+        return league(argc, argv);
+    }
+    if (strcmp(argv[1], "ab") == 0) {
+        return abtest(argc, argv);
+    }
+    if (strcmp(argv[1], "rebalance") == 0) {
+        return rebalance(argc, argv);
+    }
+    if (strcmp(argv[1], "sweep") == 0) {
+        return sweep(argc, argv);
+    }
+    if (strcmp(argv[1], "sensitivity") == 0) {
+        return sensitivity(argc, argv);
+    }
+    if (strcmp(argv[1], "plan") == 0) {
+        return planner(argc, argv);
+    }
+    if (strcmp(argv[1], "parity") == 0) {
+        return parity(argc, argv);
+    }
+    if (strcmp(argv[1], "replay") == 0) {
+        return replay(argc, argv);
+    }
+    if (strcmp(argv[1], "verify") == 0) {
+        return verify(argc, argv);
+    }
+
+    printf("Unknown mode %s\n", argv[1]);
+    printf("Usage: %s sim <bot> <bot> [matches] [seed]\n", argv[0]);
+    printf("       %s team <bot> <bot> [matches] [seed]\n", argv[0]);
+    printf("       %s train [episodes] [file] [opponent]\n", argv[0]);
+    printf("       %s league [checkpoint] [bot ...]\n", argv[0]);
+    printf("       %s ab <bot> <bot> <catalog> <formula> [pairs] [seed]\n", argv[0]);
+    printf("       %s rebalance [out]\n", argv[0]);
+    printf("       %s sweep <weapon> <column> <from> <to> [steps]\n", argv[0]);
+    printf("       %s sensitivity [matches] [bot] [bot]\n", argv[0]);
+    printf("       %s plan [balance] [T|CT]\n", argv[0]);
+    printf("       %s parity [matches] [bot] [bot]\n", argv[0]);
+    printf("       %s replay <file> [match]\n", argv[0]);
+    printf("       %s verify <file> [catalog] [formula]\n", argv[0]);
+    return 1;
+}
+
+//Removes "--name value" from the arguments, returns 1 if it was there
+int flag(int *argc, char *argv[], const char *name, double *value){
+
+    for (int i = 1; i + 1 < *argc; i++) {
+        if (strcmp(argv[i], name) == 0) {
+            *value = atof(argv[i + 1]);
+            for (int j = i; j + 2 <= *argc; j++) {
+                argv[j] = argv[j + 2];
+            }
+            *argc -= 2;
+            return 1;
+        }
+    }
+    return 0;
+}
 
-    fptr = fopen("case.txt","r");
+//Removes "--name text" from the arguments, returns 1 if it was there
+int textflag(int *argc, char *argv[], const char *name, const char **value){
 
-    int i = 0;
-    //Extracting weapon data from file
-    while (fscanf(fptr, "%s %d %d %f %d %d %f %f", ptr->name[i], &ptr->price[i], &ptr->damage[i],
-                &ptr->firerate[i], &ptr->magazine[i], &ptr->falloff[i], &ptr->range[i], &ptr->recoil[i]) != EOF && i < WEAPON) {
-        balanced[i] = ((ptr->damage[i] * ptr->firerate[i]) + (ptr->magazine[i] * ptr->range[i])) \
-        / (float)(ptr->falloff[i] + ptr->recoil[i]); 
-        i++;
+    for (int i = 1; i + 1 < *argc; i++) {
+        if (strcmp(argv[i], name) == 0) {
+            *value = argv[i + 1];
+            for (int j = i; j + 2 <= *argc; j++) {
+                argv[j] = argv[j + 2];
+            }
+            *argc -= 2;
+            return 1;
+        }
     }
+    return 0;
+}
 
-    //Balance Score = ((Damage * Fire Rate) + Magazine Size) / Falloff + Recoil
+double now(){
 
-    fclose(fptr);
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+int cores(){
+
+    if (workers > 0) {
+        return workers;
+    }
+    long n = sysconf(_SC_NPROCESSORS_ONLN);
+    return n > 0 ? (int)n : 1;
+}
+
+//Loads a catalog into ammo and rebuilds everything derived from it
+int setup(const char *file){
+
+    int n = loadcase(&ammo, file);
+    if (n < 0) {
+        return -1;
+    }
+
+    balanced = realloc(balanced, (n + 1) * sizeof(double));
+    score(&ammo, 0, balanced);
+    buildorder(&ammo);
+
+    //schedule.txt next to the catalog overrides the built-in one round per tier
+    if (sched.rounds == 0 && loadschedule(&sched, "schedule.txt") < 0) {
+        defaultschedule(&sched);
+    }
+    game.cat = &ammo;
+    game.score = balanced;
+    buildgame(&game);
+    loadpolicy(&game, &policy, "policy.bin");
+
+    return n;
+}
+
+void gamemenu(){
+
+    int i = ammo.count;
 
     int choise;
 
@@ -62,7 +971,8 @@ void gamemenu(){
         printf("\n 2. Options");
         printf("\n 3. Help");
         printf("\n 4. About");
-        printf("\n 5. Exit");
+        printf("\n 5. Team Play");
+        printf("\n 6. Exit");
 
         printf("\n\nYour Choise : " );
         scanf("%d",&choise);
@@ -71,247 +981,4744 @@ void gamemenu(){
             case 1:
                 play(&ammo);
                 break;
-            case 2: case 3:
-                // Options and Help
-                printf("Options and Help not implemented yet.\n");
+            case 2:
+                options();
+                break;
+            case 3:
+                // Help
+                printf("Help not implemented yet.\n");
                 break;
             case 4:
                 about(&ammo,i);
                 break;
+            case 5:
+                teamplay(&ammo);
+                break;
             default:
                 break;
         }
-    } while (choise != 5);
+    } while (choise != 6);
     
 }
 
-void about(struct casE *ptr, int count){
+void options(){
+
+    int choise;
+
+    printf("\n 1. Enemy bot (now %s)", enemybot->name);
+    printf("\n 2. Economy (now %s)", game.eco->name);
+    printf("\n 3. Scoring (now %s)", scorings[scoring]);
+    printf("\n\nYour Choise : ");
+    scanf("%d",&choise);
+
+    if (choise == 1) {
+        printf("\nEnemy bot (now %s)\n", enemybot->name);
+        for (int b = 0; b < BOTS; b++) {
+            printf(" %d. %s\n", b + 1, bots[b].name);
+        }
+        printf("\nYour Choise : ");
+        scanf("%d",&choise);
+        if (choise >= 1 && choise <= BOTS) {
+            enemybot = &bots[choise - 1];
+        }
+    } else if (choise == 2) {
+        printf("\nEconomy (now %s)\n", game.eco->name);
+        for (int e = 0; e < ECONOMIES; e++) {
+            printf(" %d. %s\n", e + 1, economies[e].name);
+        }
+        printf("\nYour Choise : ");
+        scanf("%d",&choise);
+        if (choise >= 1 && choise <= ECONOMIES) {
+            seteconomy(&game, &economies[choise - 1]);
+            loadpolicy(&game, &policy, "policy.bin");
+        }
+    } else if (choise == 3) {
+        scoring = !scoring;
+        setup("case.txt");
+        printf("\nScoring is now %s\n", scorings[scoring]);
+    }
+}
 
-    printf("|------------|--------|------|---------------|-------------|--------------|--------------|------|\n");
-    printf("|Weapon Name |Price($)|Damage|Fire Rate (RPM)|Magazine Size|Damage Falloff|Accurate Range|Recoil|\n");
-    printf("|------------|--------|------|---------------|-------------|--------------|--------------|------|\n");
+int loadcase(struct casE *ptr, const char *file){
 
-    //Printing weapon data to the screen
-    for (int j = 0; j < count; j++) {
-        printf("|%-12s|%8d|%6d|%15.2f|%13d|%14d|%14.2f|%6.1f|\n", ptr->name[j], ptr->price[j], ptr->damage[j],
-               ptr->firerate[j], ptr->magazine[j], ptr->falloff[j],ptr->range[j],ptr->recoil[j]);
+    FILE *fptr;
+
+    fptr = fopen(file,"r");
+    if (fptr == NULL) {
+        return -1;
+    }
+
+    char name[WEAPON], line[256], token[16];
+    int price, damage, magazine, falloff, used, more;
+    float firerate, range, recoil;
+
+    ptr->count = 0;
+    clearnames(&ptr->names);
+    //Extracting weapon data from file, growing the columns as needed. After the eight
+    //required columns a line may carry its side and its tier. Lines without a side stay
+    //buyable by both, lines without a tier take it from their position.
+    while (fgets(line, sizeof(line), fptr) != NULL) {
+        if (sscanf(line, "%33s %d %d %f %d %d %f %f%n", name, &price, &damage,
+                &firerate, &magazine, &falloff, &range, &recoil, &used) != 8) {
+            continue;
+        }
+        int side = 3, tier = -1;
+        for (int t = 0; t < 2 && sscanf(line + used, "%15s%n", token, &more) == 1; t++) {
+            used += more;
+            if (findside(token) > 0) {
+                side = findside(token);
+            } else if (findtier(token) >= 0) {
+                tier = findtier(token);
+            } else if (strcmp(token, "none") == 0) {
+                tier = TIERS;
+            }
+        }
+        //A column that cannot grow keeps its block, the catalog is then given up
+        if (ptr->count == ptr->cap) {
+            int n = ptr->count, cap = ptr->cap ? ptr->cap * 2 : 64, ok = 1;
+            ok = ok && regrow(&ptr->price, n * sizeof(int), cap * sizeof(int)) == 0;
+            ok = ok && regrow(&ptr->damage, n * sizeof(int), cap * sizeof(int)) == 0;
+            ok = ok && regrow(&ptr->firerate, n * sizeof(float), cap * sizeof(float)) == 0;
+            ok = ok && regrow(&ptr->magazine, n * sizeof(int), cap * sizeof(int)) == 0;
+            ok = ok && regrow(&ptr->falloff, n * sizeof(int), cap * sizeof(int)) == 0;
+            ok = ok && regrow(&ptr->range, n * sizeof(float), cap * sizeof(float)) == 0;
+            ok = ok && regrow(&ptr->recoil, n * sizeof(float), cap * sizeof(float)) == 0;
+            ok = ok && regrow(&ptr->side, n * sizeof(int), cap * sizeof(int)) == 0;
+            ok = ok && regrow(&ptr->tier, n * sizeof(int), cap * sizeof(int)) == 0;
+            int *off = ok ? realloc(ptr->names.off, cap * sizeof(int)) : NULL;
+            if (off != NULL) {
+                ptr->names.off = off;
+            }
+            int *len = off != NULL ? realloc(ptr->names.len, cap * sizeof(int)) : NULL;
+            if (len != NULL) {
+                ptr->names.len = len;
+            }
+            if (len == NULL) {
+                printf("Out of memory reading %s\n", file);
+                ptr->count = 0;
+                fclose(fptr);
+                return -1;
+            }
+            ptr->cap = cap;
+        }
+        int i = ptr->count++;
+        ptr->names.off[i] = intern(&ptr->names, name);
+        ptr->names.len[i] = (int)strlen(name);
+        ptr->price[i] = price;
+        ptr->damage[i] = damage;
+        ptr->firerate[i] = firerate;
+        ptr->magazine[i] = magazine;
+        ptr->falloff[i] = falloff;
+        ptr->range[i] = range;
+        ptr->recoil[i] = recoil;
+        ptr->side[i] = side;
+        ptr->tier[i] = tier;
     }
-    printf("|------------|--------|------|---------------|-------------|--------------|--------------|------|\n");
 
+    fclose(fptr);
+    indexcase(ptr);
+
+    return ptr->count;
 }
 
-void play(struct casE *ptr){
+//Moves the column col points to into a new cache line aligned block of size bytes,
+//keeping the first used. Returns -1 and leaves the column where it was without memory.
+int regrow(void *col, size_t used, size_t size){
 
-    int chs,j,wp,k,slctw,blnc,randnum,enemy=0,you=0;
-    srand(time(NULL));
-    
-    printf("Welcome the FireSync\n1) T: \n2) CT: \nPlease select your team: ");
-    scanf("%d",&chs);
-    for (size_t i = 1; i <= 5; i++){
-        k = 1;
-        switch (i){
-            case 1:
-                blnc = 900;
-                printf("Your Balance (Round %d): $%d\n",i,blnc);
-                for (size_t j = 0; j < 10; j++){
-                    printf("%d) %s $%d\n",k,ptr->name[j],ptr->price[j]);
-                    k++;
-                }
-                printf("Please Select your weapon: ");
-                scanf("%d",&slctw);
-                //Prevent possible errors
-                while (1 == 1){
-                    if (slctw > 10) {
-                        printf("An invalid number was entered\n");
-                        printf("Please Select your weapon: ");
-                        scanf("%d",&slctw);
-                    } else if(blnc < ptr->price[slctw-1]){
-                        printf("Your money isn't enough\n");
-                        printf("Please Select your weapon: ");
-                        scanf("%d",&slctw);
-                    }
-                    else {
-                        break;
-                    }
-                }
-                blnc -= ptr->price[slctw-1];
-                randnum = rand() % 10;
-                printf("Your Weapon is %s \nEnemy Weapon is %s",ptr->name[slctw-1],ptr->name[randnum]);
-                usleep(1000000);
-                //Showing the result of the round and the winner
-                if (balanced[slctw-1] > balanced[randnum]){
-                    printf("\nYou win\n");
-                    you++;
-                } else {
-                    printf("\nYou lose\n");
-                    enemy++;
-                }
-                printf("Score Table : %d %d\n",you,enemy);
-                break;
-            case 2: 
-                blnc += 1700;
-                printf("Your Balance (Round %d): $%d\n",i,blnc);
-                for (size_t j = 10; j < 17; j++){
-                    printf("%d) %s $%d\n",k,ptr->name[j],ptr->price[j]);
-                    k++;
-                }
-                printf("Please Select your weapon: ");
-                scanf("%d",&slctw);
-                //Prevent possible errors
-                while (1 == 1){
-                    if (slctw > 7) {
-                        printf("An invalid number was entered\n");
-                        printf("Please Select your weapon: ");
-                        scanf("%d",&slctw);
-                    } else if(blnc < ptr->price[10+(slctw-1)]){
-                        printf("Your money isn't enough\n");
-                        printf("Please Select your weapon: ");
-                        scanf("%d",&slctw);
-                    }
-                    else {
-                        break;
-                    }
-                }
-                //Balance reduction
-                blnc -= ptr->price[10+(slctw-1)];
-                //Weapon selection part of the bot
-                randnum = (rand() % 7) + 10;
-                printf("Your Weapon is %s \nEnemy Weapon is %s",ptr->name[10+(slctw-1)],ptr->name[randnum]);
-                usleep(1000000);
-                //Showing the result of the round and the winner
-                if (balanced[10+(slctw-1)] > balanced[randnum]){
-                    printf("\nYou win\n");
-                    you++;
-                } else {
-                    printf("\nYou lose\n");
-                    enemy++;
-                }
-                printf("Score Table : %d %d\n",you,enemy);
-                break;
-            case 3:
-                blnc += 2000;
-                printf("Your Balance (Round %d): $%d\n",i,blnc);
-                for (size_t j = 17; j < 23; j++){
-                    printf("%d) %s $%d\n",k,ptr->name[j],ptr->price[j]);
-                    k++;
-                }
-                printf("Please Select your weapon: ");
-                scanf("%d",&slctw);
-                //Prevent possible errors
-                while (1 == 1){
-                    if (slctw > 6) {
-                        printf("An invalid number was entered\n");
-                        printf("Please Select your weapon: ");
-                        scanf("%d",&slctw);
-                    } else if(blnc < ptr->price[17+(slctw-1)]){
-                        printf("Your money isn't enough\n");
-                        printf("Please Select your weapon: ");
-                        scanf("%d",&slctw);
-                    }
-                    else {
-                        break;
-                    }
-                }
-                //Balance reduction
-                blnc -= ptr->price[17+(slctw-1)];
-                //Weapon selection part of the bot
-                randnum = (rand() % 6) + 17;
-                printf("Your Weapon is %s \nEnemy Weapon is %s",ptr->name[17+(slctw-1)],ptr->name[randnum]);
-                usleep(1000000);
-                //Showing the result of the round and the winner
-                if (balanced[17+(slctw-1)] > balanced[randnum]){
-                    printf("\nYou win\n");
-                    you++;
-                } else {
-                    printf("\nYou lose\n");
-                    enemy++;
-                }
-                printf("Score Table : %d %d\n",you,enemy);
-                break;
-            case 4:
-                blnc += 2600;
-                printf("Your Balance (Round %d): $%d\n",i,blnc);
-                for (size_t j = 23; j < 30; j++){
-                    printf("%d) %s $%d\n",k,ptr->name[j],ptr->price[j]);
-                    k++;
-                }
-                printf("Please Select your weapon: ");
-                scanf("%d",&slctw);
-                //Prevent possible errors
-                while (1 == 1){
-                    if (slctw > 7) {
-                        printf("An invalid number was entered\n");
-                        printf("Please Select your weapon: ");
-                        scanf("%d",&slctw);
-                    } else if(blnc < ptr->price[23+(slctw-1)]){
-                        printf("Your money isn't enough\n");
-                        printf("Please Select your weapon: ");
-                        scanf("%d",&slctw);
-                    }
-                    else {
-                        break;
-                    }
-                }
-                //Balance reduction
-                blnc -= ptr->price[23+(slctw-1)];
-                //Weapon selection part of the bot
-                randnum = (rand() % 7) + 23;
-                printf("Your Weapon is %s \nEnemy Weapon is %s",ptr->name[23+(slctw-1)],ptr->name[randnum]);
-                usleep(1000000);
-                //Showing the result of the round and the winner
-                if (balanced[23+(slctw-1)] > balanced[randnum]){
-                    printf("\nYou win\n");
-                    you++;
-                } else {
-                    printf("\nYou lose\n");
-                    enemy++;
-                }
-                printf("Score Table : %d %d\n",you,enemy);
-                break;
-            case 5:
-                blnc += 3500;
-                printf("Your Balance (Round %d): $%d\n",i,blnc);
-                for (size_t j = 30; j < 34; j++){
-                    printf("%d) %s $%d\n",k,ptr->name[j],ptr->price[j]);
-                    k++;
-                }
-                printf("Please Select your weapon: ");
-                scanf("%d",&slctw);
-                //Prevent possible errors
-                while (1 == 1){
-                    if (slctw > 4) {
-                        printf("An invalid number was entered\n");
-                        printf("Please Select your weapon: ");
-                        scanf("%d",&slctw);
-                    } else if(blnc < ptr->price[30+(slctw-1)]){
-                        printf("Your money isn't enough\n");
-                        printf("Please Select your weapon: ");
-                        scanf("%d",&slctw);
-                    }
-                    else {
-                        break;
-                    }
+    void *p, *q = NULL;
+    memcpy(&p, col, sizeof(p));
+    if (posix_memalign(&q, LINE, size) != 0) {
+        return -1;
+    }
+    if (p != NULL) {
+        memcpy(q, p, used);
+        free(p);
+    }
+    memcpy(col, &q, sizeof(q));
+    return 0;
+}
+
+void clearnames(struct nameS *n){
+
+    n->used = 0;
+    n->names = 0;
+    for (int k = 0; k < n->slots; k++) {
+        n->slot[k] = 0;
+    }
+}
+
+//Offset of s in the string table, appended the first time it is seen
+int intern(struct nameS *n, const char *s){
+
+    unsigned h = 2166136261u;
+    for (const char *c = s; *c; c++) {
+        h = (h ^ (unsigned char)*c) * 16777619u;
+    }
+    //The table stays at most half full, growing rehashes what is already in
+    if (2 * (n->names + 1) > n->slots) {
+        int slots = n->slots ? 2 * n->slots : 64, *slot = calloc(slots, sizeof(int));
+        for (int k = 0; k < n->slots; k++) {
+            if (n->slot[k] > 0) {
+                unsigned g = 2166136261u;
+                for (const char *c = n->text + n->slot[k] - 1; *c; c++) {
+                    g = (g ^ (unsigned char)*c) * 16777619u;
                 }
-                //Balance reduction
-                blnc -= ptr->price[30+(slctw-1)];
-                //Weapon selection part of the bot
-                randnum = (rand() % 4) + 30;
-                printf("Your Weapon is %s \nEnemy Weapon is %s",ptr->name[30+(slctw-1)],ptr->name[randnum]);
-                usleep(1000000);
-                //Showing the result of the round and the winner
-                if (balanced[30+(slctw-1)] > balanced[randnum]){
-                    printf("\nYou win\n");
-                    you++;
-                } else {
-                    printf("\nYou lose\n");
-                    enemy++;
+                int e = g & (slots - 1);
+                while (slot[e] > 0) e = (e + 1) & (slots - 1);
+                slot[e] = n->slot[k];
+            }
+        }
+        free(n->slot);
+        n->slot = slot;
+        n->slots = slots;
+    }
+    int e = h & (n->slots - 1);
+    while (n->slot[e] > 0) {
+        if (strcmp(n->text + n->slot[e] - 1, s) == 0) {
+            return n->slot[e] - 1;
+        }
+        e = (e + 1) & (n->slots - 1);
+    }
+    int len = (int)strlen(s) + 1;
+    if (n->used + len > n->size) {
+        n->size = n->size ? n->size * 2 : 1024;
+        while (n->used + len > n->size) n->size *= 2;
+        n->text = realloc(n->text, n->size);
+    }
+    memcpy(n->text + n->used, s, len);
+    n->slot[e] = n->used + 1;
+    n->names++;
+    n->used += len;
+    return n->used - len;
+}
+
+//Fills in positional tiers and builds the row list of every tier
+void indexcase(struct casE *ptr){
+
+    for (int r = 0; r < TIERS; r++) {
+        ptr->tierrows[r] = 0;
+    }
+    for (int j = 0; j < ptr->count; j++) {
+        if (ptr->tier[j] < 0) {
+            ptr->tier[j] = TIERS;
+            for (int r = 0; r < TIERS; r++) {
+                if (j >= slice[r][0] && j < slice[r][0] + slice[r][1]) {
+                    ptr->tier[j] = r;
                 }
-                printf("Score Table : %d %d\n",you,enemy);
-                break;
-            default:
-                break;
+            }
+        }
+        if (ptr->tier[j] < TIERS) {
+            ptr->tierrows[ptr->tier[j]]++;
+        }
+    }
+    for (int r = 0; r < TIERS; r++) {
+        ptr->tierrow[r] = realloc(ptr->tierrow[r], (ptr->tierrows[r] + 1) * sizeof(int));
+        ptr->tierrows[r] = 0;
+    }
+    for (int j = 0; j < ptr->count; j++) {
+        int r = ptr->tier[j];
+        if (r < TIERS) {
+            ptr->tierrow[r][ptr->tierrows[r]++] = j;
+        }
+    }
+}
+
+//Side mask of a catalog token, 0 if it names no side
+int findside(const char *name){
+
+    for (int s = 0; s < 3; s++) {
+        if (strcmp(sidename[s], name) == 0) {
+            return s + 1;
+        }
+    }
+    return 0;
+}
+
+void score(struct casE *ptr, int formula, double *out){
+
+    if (scoring == 1) {
+        for (int i = 0; i < ptr->count; i++) {
+            out[i] = fixedscore(ptr->damage[i], ptr->firerate[i], ptr->magazine[i], ptr->falloff[i], ptr->range[i],
+                                ptr->recoil[i], formula) / 65536.0;
+        }
+        return;
+    }
+
+    //Balance Score = ((Damage * Fire Rate) + (Magazine Size * Accurate Range)) / (Falloff + Recoil)
+    if (formula == 0) {
+        for (int i = 0; i < ptr->count; i++) {
+            out[i] = ((ptr->damage[i] * ptr->firerate[i]) + (ptr->magazine[i] * ptr->range[i])) \
+            / (float)(ptr->falloff[i] + ptr->recoil[i]);
+        }
+        return;
+    }
+
+    //DPS Score = (Damage * Fire Rate) / (Falloff + Recoil)
+    for (int i = 0; i < ptr->count; i++) {
+        out[i] = (ptr->damage[i] * ptr->firerate[i]) / (float)(ptr->falloff[i] + ptr->recoil[i]);
+    }
+}
+
+//Balance score in 1/65536 units from integer arithmetic only. The float stats are taken
+//to the nearest hundredth, the score rounds half up, and a weapon with neither falloff
+//nor recoil scores 0.
+long long fixedscore(int damage, float firerate, int magazine, int falloff, float range, float recoil, int formula){
+
+    long long f = lround(firerate * 100.0), r = lround(range * 100.0), c = lround(recoil * 100.0);
+    long long num = damage * f + (formula == 0 ? magazine * r : 0);
+    long long den = falloff * 100LL + c;
+    if (den <= 0) {
+        return 0;
+    }
+    return (num * 131072 + den) / (2 * den);
+}
+
+double column(struct casE *ptr, int c, int j){
+
+    switch (c) {
+        case 0: return ptr->price[j];
+        case 1: return ptr->damage[j];
+        case 2: return ptr->firerate[j];
+        case 3: return ptr->magazine[j];
+        case 4: return ptr->falloff[j];
+        case 5: return ptr->range[j];
+        case 6: return ptr->recoil[j];
+        default: return balanced[j];
+    }
+}
+
+//Stable LSD radix sort of (key, perm) pairs, one byte per pass
+void radixsort(unsigned long long *key, int *perm, int n){
+
+    unsigned long long *ktmp = malloc(n * sizeof(unsigned long long));
+    int *ptmp = malloc(n * sizeof(int));
+
+    for (int shift = 0; shift < 64; shift += 8) {
+        int bucket[257] = {0};
+        for (int i = 0; i < n; i++) {
+            bucket[((key[i] >> shift) & 0xff) + 1]++;
+        }
+        //Every key shares this byte, the pass would not move anything
+        if (bucket[((key[0] >> shift) & 0xff) + 1] == n) {
+            continue;
+        }
+        for (int b = 0; b < 256; b++) {
+            bucket[b + 1] += bucket[b];
+        }
+        for (int i = 0; i < n; i++) {
+            int to = bucket[(key[i] >> shift) & 0xff]++;
+            ktmp[to] = key[i];
+            ptmp[to] = perm[i];
+        }
+        memcpy(key, ktmp, n * sizeof(unsigned long long));
+        memcpy(perm, ptmp, n * sizeof(int));
+    }
+
+    free(ktmp);
+    free(ptmp);
+}
+
+//Maps a double onto an unsigned key with the same ordering
+unsigned long long orderkey(double v){
+
+    unsigned long long bits;
+    memcpy(&bits, &v, sizeof(bits));
+    return (bits >> 63) ? ~bits : bits | (1ULL << 63);
+}
+
+void buildorder(struct casE *ptr){
+
+    int n = ptr->count;
+    if (n == 0) {
+        return;
+    }
+    unsigned long long *key = malloc(n * sizeof(unsigned long long));
+
+    for (int c = 0; c < COLUMNS; c++) {
+        order[c] = realloc(order[c], n * sizeof(int));
+        for (int j = 0; j < n; j++) {
+            key[j] = orderkey(column(ptr, c, j));
+            order[c][j] = j;
+        }
+        radixsort(key, order[c], n);
+    }
+
+    free(key);
+}
+
+//Parses "price <= 2000 and range > 20", returns the number of terms or -1
+int parsefilter(const char *s, struct filteR *term){
+
+    const char *ops[6] = {"<=", ">=", "==", "!=", "<", ">"};
+    int n = 0;
+
+    while (1) {
+        while (*s == ' ' || *s == '\t') s++;
+        if (*s == '\0' || *s == '\n') {
+            return n;
+        }
+        if (n > 0) {
+            if (strncmp(s, "and", 3) != 0) {
+                return -1;
+            }
+            s += 3;
+            while (*s == ' ' || *s == '\t') s++;
+        }
+        if (n == TERMS) {
+            return -1;
+        }
+        int len = 0;
+        while (s[len] >= 'a' && s[len] <= 'z') len++;
+        term[n].col = -1;
+        for (int c = 0; c < COLUMNS; c++) {
+            if (len > 0 && (int)strlen(columns[c]) == len && strncmp(s, columns[c], len) == 0) {
+                term[n].col = c;
+            }
+        }
+        if (term[n].col < 0) {
+            return -1;
+        }
+        s += len;
+        while (*s == ' ' || *s == '\t') s++;
+        term[n].op = -1;
+        for (int o = 0; o < 6; o++) {
+            if (strncmp(s, ops[o], strlen(ops[o])) == 0) {
+                term[n].op = o;
+                s += strlen(ops[o]);
+                break;
+            }
+        }
+        if (term[n].op < 0) {
+            return -1;
+        }
+        char *end;
+        term[n].value = strtod(s, &end);
+        if (end == s) {
+            return -1;
+        }
+        s = end;
+        n++;
+    }
+}
+
+void readline(char *buf, int n){
+
+    if (fgets(buf, n, stdin) == NULL) {
+        buf[0] = '\0';
+    }
+    buf[strcspn(buf, "\n")] = '\0';
+}
+
+void about(struct casE *ptr, int count){
+
+    char line[256];
+    struct filteR term[TERMS];
+    int sort = -1, desc = 0, terms;
+
+    //Drop the rest of the menu input line
+    int c;
+    while ((c = getchar()) != '\n' && c != EOF);
+
+    printf("Sort by (price, damage, firerate, magazine, falloff, range, recoil, balance;\n"
+           "prefix with - for descending, empty for file order): ");
+    readline(line, sizeof(line));
+    if (line[0] != '\0') {
+        desc = line[0] == '-';
+        for (int k = 0; k < COLUMNS; k++) {
+            if (strcmp(line + desc, columns[k]) == 0) {
+                sort = k;
+            }
+        }
+        if (sort < 0) {
+            printf("Unknown column %s\n", line + desc);
+            return;
+        }
+    }
+
+    printf("Filter (e.g. price <= 2000 and range > 20, empty for none): ");
+    readline(line, sizeof(line));
+    terms = parsefilter(line, term);
+    if (terms < 0) {
+        printf("Invalid filter\n");
+        return;
+    }
+
+    //Range terms on the sort column narrow the scan by binary search on its index
+    int lo = 0, hi = count;
+    if (sort >= 0) {
+        for (int t = 0; t < terms; t++) {
+            if (term[t].col != sort || term[t].op == 3) {
+                continue;
+            }
+            int first = 0, last = count;
+            while (first < last) {
+                int mid = (first + last) / 2;
+                if (column(ptr, sort, order[sort][mid]) < term[t].value) first = mid + 1; else last = mid;
+            }
+            int below = first;
+            last = count;
+            while (first < last) {
+                int mid = (first + last) / 2;
+                if (column(ptr, sort, order[sort][mid]) <= term[t].value) first = mid + 1; else last = mid;
+            }
+            int upto = first;
+            switch (term[t].op) {
+                case 0: if (upto < hi) hi = upto; break;
+                case 1: if (below > lo) lo = below; break;
+                case 2: if (below > lo) lo = below; if (upto < hi) hi = upto; break;
+                case 4: if (below < hi) hi = below; break;
+                case 5: if (upto > lo) lo = upto; break;
+            }
+        }
+    }
+
+    printf("|------------|--------|------|---------------|-------------|--------------|--------------|------|-------|\n");
+    printf("|Weapon Name |Price($)|Damage|Fire Rate (RPM)|Magazine Size|Damage Falloff|Accurate Range|Recoil|Balance|\n");
+    printf("|------------|--------|------|---------------|-------------|--------------|--------------|------|-------|\n");
+
+    //Printing weapon data to the screen a page at a time
+    int shown = 0;
+    for (int p = lo; p < hi; p++) {
+        int j = p;
+        if (sort >= 0) {
+            j = desc ? order[sort][lo + hi - 1 - p] : order[sort][p];
+        }
+        int keep = 1;
+        for (int t = 0; t < terms && keep; t++) {
+            double v = column(ptr, term[t].col, j);
+            switch (term[t].op) {
+                case 0: keep = v <= term[t].value; break;
+                case 1: keep = v >= term[t].value; break;
+                case 2: keep = v == term[t].value; break;
+                case 3: keep = v != term[t].value; break;
+                case 4: keep = v < term[t].value; break;
+                case 5: keep = v > term[t].value; break;
+            }
+        }
+        if (!keep) {
+            continue;
+        }
+        if (shown > 0 && shown % PAGE == 0) {
+            printf("-- Enter for the next page, q to stop -- ");
+            readline(line, sizeof(line));
+            if (line[0] == 'q') {
+                break;
+            }
+        }
+        printf("|%-12s|%8d|%6d|%15.2f|%13d|%14d|%14.2f|%6.1f|%7.1f|\n", wname(ptr, j), ptr->price[j], ptr->damage[j],
+               ptr->firerate[j], ptr->magazine[j], ptr->falloff[j],ptr->range[j],ptr->recoil[j],balanced[j]);
+        shown++;
+    }
+    printf("|------------|--------|------|---------------|-------------|--------------|--------------|------|-------|\n");
+
+}
+
+//Tier of the rows in the tiers of mask whose side mask shares a bit with sides, tier by
+//tier in catalog order. Sides 3 takes the rows of either side.
+void buildtier(struct casE *ptr, const double *score, int sides, int mask, struct tieR *t){
+
+    int n = 0;
+    for (int r = 0; r < TIERS; r++) {
+        for (int k = 0; (mask >> r & 1) && k < ptr->tierrows[r]; k++) {
+            n += (ptr->side[ptr->tierrow[r][k]] & sides) != 0;
+        }
+    }
+    t->count = n;
+    t->idx = realloc(t->idx, (n + 1) * sizeof(int));
+    t->byprice = realloc(t->byprice, (n + 1) * sizeof(int));
+    t->price = realloc(t->price, (n + 1) * sizeof(int));
+    t->best = realloc(t->best, (n + 1) * sizeof(int));
+    if (n == 0) {
+        t->breaks = 0;
+        return;
+    }
+
+    //perm is the price order of tier-local rows
+    unsigned long long *key = malloc(n * sizeof(unsigned long long));
+    int *perm = malloc(n * sizeof(int));
+    for (int r = 0, k = 0; r < TIERS; r++) {
+        for (int i = 0; (mask >> r & 1) && i < ptr->tierrows[r]; i++) {
+            int j = ptr->tierrow[r][i];
+            if (ptr->side[j] & sides) {
+                t->idx[k] = j;
+                perm[k] = k;
+                key[k++] = (unsigned long long)ptr->price[j];
+            }
+        }
+    }
+    radixsort(key, perm, n);
+    for (int k = 0; k < n; k++) {
+        t->byprice[k] = t->idx[perm[k]];
+    }
+
+    //Prefix maximum of the balance score along the price order
+    for (int k = 0; k < n; k++) {
+        int j = t->byprice[k];
+        t->price[k] = ptr->price[j];
+        t->best[k] = (k > 0 && score[t->best[k - 1]] >= score[j]) ? t->best[k - 1] : j;
+    }
+    free(key);
+
+    //Affordable sets only change at distinct prices, each one extends the previous
+    int words = (n + 63) / 64, b = -1;
+    t->words = words;
+    t->brk = realloc(t->brk, n * sizeof(int));
+    t->afford = realloc(t->afford, (size_t)n * words * sizeof(unsigned long long));
+    for (int k = 0; k < n; k++) {
+        if (b < 0 || t->price[k] != t->brk[b]) {
+            b++;
+            t->brk[b] = t->price[k];
+            if (b == 0) {
+                memset(t->afford, 0, words * sizeof(unsigned long long));
+            } else {
+                memcpy(t->afford + (size_t)b * words, t->afford + (size_t)(b - 1) * words,
+                       words * sizeof(unsigned long long));
+            }
+        }
+        int local = perm[k];
+        t->afford[(size_t)b * words + local / 64] |= 1ULL << (local % 64);
+    }
+    t->breaks = b + 1;
+    free(perm);
+}
+
+int findtier(const char *name){
+
+    for (int r = 0; r < TIERS; r++) {
+        if (strcmp(tiername[r], name) == 0) {
+            return r;
+        }
+    }
+    return -1;
+}
+
+//Index of the pool of a tier mask, added with a name like "pistol+smg" when new
+int addpool(struct scheD *s, int mask){
+
+    for (int p = 0; p < s->pools; p++) {
+        if (s->mask[p] == mask) {
+            return p;
+        }
+    }
+    int p = s->pools++;
+    s->mask = realloc(s->mask, s->pools * sizeof(int));
+    s->name = realloc(s->name, s->pools * sizeof(*s->name));
+    s->mask[p] = mask;
+    s->name[p][0] = 0;
+    for (int r = 0; r < TIERS; r++) {
+        if (mask >> r & 1) {
+            if (s->name[p][0]) strcat(s->name[p], "+");
+            strcat(s->name[p], tiername[r]);
+        }
+    }
+    return p;
+}
+
+void addround(struct scheD *s, int pool, int pay){
+
+    int r = s->rounds++;
+    s->draw = realloc(s->draw, s->rounds * sizeof(int));
+    s->pay = realloc(s->pay, s->rounds * sizeof(int));
+    s->draw[r] = pool;
+    s->pay[r] = pay;
+}
+
+void freeschedule(struct scheD *s){
+
+    free(s->draw);
+    free(s->pay);
+    free(s->mask);
+    free(s->name);
+    memset(s, 0, sizeof(*s));
+}
+
+//One round per tier with the income play() has always paid
+void defaultschedule(struct scheD *s){
+
+    freeschedule(s);
+    for (int r = 0; r < TIERS; r++) {
+        addround(s, addpool(s, 1 << r), income[r]);
+    }
+    s->builtin = 1;
+}
+
+//Lines are "<tier>[+<tier>...] <income> [rounds]" or "firstto <wins>", # starts a
+//comment. The schedule is only replaced when the whole file is valid.
+int loadschedule(struct scheD *s, const char *file){
+
+    FILE *fptr = fopen(file, "r");
+    if (fptr == NULL) {
+        return -1;
+    }
+    struct scheD t;
+    memset(&t, 0, sizeof(t));
+    char line[256], tiers[128];
+    int pay, count, ok = 1;
+    while (ok && fgets(line, sizeof(line), fptr) != NULL) {
+        char *note = strchr(line, '#');
+        if (note != NULL) {
+            *note = 0;
+        }
+        if (sscanf(line, " firstto %d", &t.firstto) == 1) {
+            continue;
+        }
+        int fields = sscanf(line, "%127s %d %d", tiers, &pay, &count);
+        if (fields < 1) {
+            continue;
+        }
+        if (fields < 3) {
+            count = 1;
+        }
+        int mask = 0;
+        for (char *tok = strtok(tiers, "+"); tok != NULL && fields >= 2; tok = strtok(NULL, "+")) {
+            mask |= findtier(tok) < 0 ? 1 << TIERS : 1 << findtier(tok);
+        }
+        ok = fields >= 2 && mask > 0 && mask < 1 << TIERS && count > 0 && pay >= 0;
+        for (int c = 0; ok && c < count; c++) {
+            addround(&t, addpool(&t, mask), pay);
+        }
+    }
+    fclose(fptr);
+    if (!ok || t.rounds == 0 || t.firstto < 0) {
+        freeschedule(&t);
+        return -1;
+    }
+    freeschedule(s);
+    *s = t;
+    return s->rounds;
+}
+
+//Row with the highest balanced[] the budget can pay for in the tier, -1 if none
+int bestbuy(const struct tieR *t, int budget){
+
+    int first = 0, last = t->count;
+    while (first < last) {
+        int mid = (first + last) / 2;
+        if (t->price[mid] <= budget) first = mid + 1; else last = mid;
+    }
+    return first > 0 ? t->best[first - 1] : -1;
+}
+
+//Index of the last price breakpoint the budget reaches, -1 below the cheapest row
+int breakpoint(const struct tieR *t, int budget){
+
+    int first = 0, last = t->breaks;
+    while (first < last) {
+        int mid = (first + last) / 2;
+        if (t->brk[mid] <= budget) first = mid + 1; else last = mid;
+    }
+    return first - 1;
+}
+
+int canafford(const struct tieR *t, int k, int budget){
+
+    int b = breakpoint(t, budget);
+    if (b < 0) {
+        return 0;
+    }
+    return (t->afford[(size_t)b * t->words + k / 64] >> (k % 64)) & 1;
+}
+
+int affordcount(const struct tieR *t, int budget){
+
+    int b = breakpoint(t, budget), n = 0;
+    if (b < 0) {
+        return 0;
+    }
+    const unsigned long long *set = t->afford + (size_t)b * t->words;
+    for (int w = 0; w < t->words; w++) {
+        n += __builtin_popcountll(set[w]);
+    }
+    return n;
+}
+
+//Uniform pick among the rows the budget can pay for, -1 if none
+int affordpick(const struct tieR *t, int budget, struct rnG *rng){
+
+    int b = breakpoint(t, budget);
+    if (b < 0) {
+        return -1;
+    }
+    const unsigned long long *set = t->afford + (size_t)b * t->words;
+    int n = 0;
+    for (int w = 0; w < t->words; w++) {
+        n += __builtin_popcountll(set[w]);
+    }
+    //Select the r-th set bit: skip whole words, then clear the lower bits of the last one
+    int r = rndint(rng, n), w = 0;
+    while (r >= __builtin_popcountll(set[w])) {
+        r -= __builtin_popcountll(set[w]);
+        w++;
+    }
+    unsigned long long bits = set[w];
+    while (r-- > 0) {
+        bits &= bits - 1;
+    }
+    return t->idx[w * 64 + __builtin_ctzll(bits)];
+}
+
+unsigned long long rnd(struct rnG *rng){
+
+    unsigned long long z = (rng->s += 0x9e3779b97f4a7c15ULL);
+    z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9ULL;
+    z = (z ^ (z >> 27)) * 0x94d049bb133111ebULL;
+    return (z ^ (z >> 31)) ^ rng->flip;
+}
+
+//Uniform integer in [0, n) by multiply-shift, no modulo bias worth caring about
+int rndint(struct rnG *rng, int n){
+
+    return (int)(((rnd(rng) >> 32) * (unsigned long long)n) >> 32);
+}
+
+void buildalias(struct aliaS *a, const double *w, int n){
+
+    a->n = n;
+    a->prob = realloc(a->prob, (n + 1) * sizeof(double));
+    a->alias = realloc(a->alias, (n + 1) * sizeof(int));
+    a->weight = realloc(a->weight, (n + 1) * sizeof(double));
+    if (n == 0) {
+        return;
+    }
+    memcpy(a->weight, w, n * sizeof(double));
+
+    double sum = 0;
+    for (int k = 0; k < n; k++) {
+        sum += w[k] > 0 ? w[k] : 0;
+    }
+
+    //Scaled weights average 1, rows under 1 borrow the rest of their slot from a row over 1
+    int *small = malloc(n * sizeof(int));
+    int *large = malloc(n * sizeof(int));
+    int ns = 0, nl = 0;
+    for (int k = 0; k < n; k++) {
+        a->prob[k] = sum > 0 ? (w[k] > 0 ? w[k] : 0) * n / sum : 1.0;
+        a->alias[k] = k;
+        if (a->prob[k] < 1.0) small[ns++] = k; else large[nl++] = k;
+    }
+    while (ns > 0 && nl > 0) {
+        int s = small[--ns], l = large[--nl];
+        a->alias[s] = l;
+        a->prob[l] -= 1.0 - a->prob[s];
+        if (a->prob[l] < 1.0) small[ns++] = l; else large[nl++] = l;
+    }
+    //Leftovers are 1 up to rounding error
+    while (nl > 0) a->prob[large[--nl]] = 1.0;
+    while (ns > 0) a->prob[small[--ns]] = 1.0;
+
+    free(small);
+    free(large);
+}
+
+//Rebuilds the table only when the weight vector differs, returns 1 if it did
+int setweights(struct aliaS *a, const double *w, int n){
+
+    if (a->n == n && a->weight != NULL && memcmp(a->weight, w, n * sizeof(double)) == 0) {
+        return 0;
+    }
+    buildalias(a, w, n);
+    return 1;
+}
+
+//Tier-local row drawn with one random number: high half picks the slot, low half the coin
+int aliaspick(const struct aliaS *a, struct rnG *rng){
+
+    unsigned long long x = rnd(rng);
+    int k = (int)(((x >> 32) * (unsigned long long)a->n) >> 32);
+    return (x & 0xffffffffULL) * (1.0 / 4294967296.0) < a->prob[k] ? k : a->alias[k];
+}
+
+//Weighted pick restricted to what the budget can pay for, -1 if nothing is affordable
+int weightedpick(const struct tieR *t, const struct aliaS *a, int budget, struct rnG *rng){
+
+    int b = breakpoint(t, budget);
+    if (b < 0) {
+        return -1;
+    }
+    const unsigned long long *set = t->afford + (size_t)b * t->words;
+    //Rejection keeps the weights exact; a tier that is mostly out of reach falls back to uniform
+    for (int tries = 0; tries < 16; tries++) {
+        int k = aliaspick(a, rng);
+        if ((set[k / 64] >> (k % 64)) & 1) {
+            return t->idx[k];
+        }
+    }
+    return affordpick(t, budget, rng);
+}
+
+void buildgame(struct gamE *g){
+
+    //Pool arrays follow the schedule, they start over when its pool count changed
+    if (g->pools != sched.pools || g->pool == NULL) {
+        freegame(g);
+        g->pools = sched.pools;
+        g->pool = calloc(g->pools, sizeof(struct tieR));
+        g->matchup = calloc(g->pools, sizeof(signed char *));
+        for (int s = 0; s < 2; s++) {
+            g->sides[s] = calloc(g->pools, sizeof(struct tieR));
+            g->share[s] = calloc(g->pools, sizeof(struct aliaS));
+        }
+    }
+    for (int r = 0; r < TIERS; r++) {
+        buildtier(g->cat, g->score, 3, 1 << r, &g->tier[r]);
+        g->tier[r].name = tiername[r];
+    }
+    g->rounds = sched.rounds;
+    g->firstto = sched.firstto;
+    g->draw = sched.draw;
+    g->pay = sched.pay;
+    for (int p = 0; p < g->pools; p++) {
+        buildtier(g->cat, g->score, 3, sched.mask[p], &g->pool[p]);
+        g->pool[p].name = sched.name[p];
+        for (int s = 0; s < 2; s++) {
+            buildtier(g->cat, g->score, s + 1, sched.mask[p], &g->sides[s][p]);
+            g->sides[s][p].name = sched.name[p];
+        }
+    }
+    g->seat[0] = 0;
+    g->seat[1] = 1;
+    seteconomy(g, g->eco != NULL ? g->eco : &economies[0]);
+
+    //Each row weighs as many rows of the other side's pool as it beats outright
+    for (int p = 0; p < g->pools; p++) {
+        const struct tieR *t = &g->sides[0][p], *c = &g->sides[1][p];
+        g->matchup[p] = realloc(g->matchup[p], (size_t)t->count * c->count + 1);
+        double *w[2] = {calloc(t->count + 1, sizeof(double)), calloc(c->count + 1, sizeof(double))};
+        for (int k = 0; k < t->count; k++) {
+            signed char *row = g->matchup[p] + (size_t)k * c->count;
+            double st = g->score[t->idx[k]];
+            for (int l = 0; l < c->count; l++) {
+                double sc = g->score[c->idx[l]];
+                row[l] = st > sc ? 1 : st < sc ? -1 : 0;
+                w[0][k] += row[l] > 0;
+                w[1][l] += row[l] < 0;
+            }
+        }
+        //A candidate edit only moves the weights of the pools holding its row, the
+        //other tables are kept as they are
+        setweights(&g->share[0][p], w[0], t->count);
+        setweights(&g->share[1][p], w[1], c->count);
+        free(w[0]);
+        free(w[1]);
+    }
+}
+
+//Switches the money rules, every row's kill reward comes from its tier
+void seteconomy(struct gamE *g, const struct ecoN *e){
+
+    int n = g->cat->count;
+    g->eco = e;
+    g->kill = realloc(g->kill, (n + 1) * sizeof(int));
+    for (int j = 0; j <= n; j++) {
+        g->kill[j] = 0;
+    }
+    for (int r = 0; r < TIERS; r++) {
+        for (int k = 0; k < g->tier[r].count; k++) {
+            g->kill[g->tier[r].idx[k]] = e->kill[r];
+        }
+    }
+}
+
+const struct ecoN *findeconomy(const char *name){
+
+    for (int e = 0; e < ECONOMIES; e++) {
+        if (strcmp(economies[e].name, name) == 0) {
+            return &economies[e];
+        }
+    }
+    return NULL;
+}
+
+//Rows the side playing a seat may buy in a round
+const struct tieR *seattier(const struct gamE *g, int seat, int round){
+
+    return &g->sides[g->seat[seat]][g->draw[round]];
+}
+
+//Rows either side may buy in a round
+const struct tieR *roundtier(const struct gamE *g, int round){
+
+    return &g->pool[g->draw[round]];
+}
+
+//Money both sides are paid at the start of a round
+int roundincome(const struct gamE *g, int round){
+
+    return g->pay[round] * g->eco->income / 100;
+}
+
+const char *wname(const struct casE *ptr, int j){
+
+    return j < 0 ? "nothing" : ptr->names.text + ptr->names.off[j];
+}
+
+const struct boT *findbot(const char *name){
+
+    for (int b = 0; b < BOTS; b++) {
+        if (strcmp(bots[b].name, name) == 0) {
+            return &bots[b];
+        }
+    }
+    return NULL;
+}
+
+//Uniform among the weapons it can pay for
+int randombot(const struct boT *bot, const struct rounD *r, struct rnG *rng){
+
+    (void)bot;
+    return affordpick(r->t, r->balance, rng);
+}
+
+//Always the best weapon it can pay for
+int greedybot(const struct boT *bot, const struct rounD *r, struct rnG *rng){
+
+    (void)bot;
+    (void)rng;
+    return bestbuy(r->t, r->balance);
+}
+
+//Keeps enough money to buy the top weapon of every later pool, else buys the cheapest
+int ecobot(const struct boT *bot, const struct rounD *r, struct rnG *rng){
+
+    (void)bot;
+    (void)rng;
+    int reserve = 0;
+    unsigned long long seen = 0;
+    for (int k = r->round + 1; k < r->g->rounds; k++) {
+        const struct tieR *t = seattier(r->g, r->side, k);
+        int paid = roundincome(r->g, k);
+        if ((seen >> r->g->draw[k] & 1) == 0 && t->count > 0 && t->price[t->count - 1] > paid) {
+            reserve += t->price[t->count - 1] - paid;
+        }
+        seen |= 1ULL << r->g->draw[k];
+    }
+    int w = bestbuy(r->t, r->balance - reserve);
+    if (w < 0 && r->t->count > 0 && r->t->price[0] <= r->balance) {
+        w = r->t->byprice[0];
+    }
+    return w;
+}
+
+//Mixes affordable weapons in proportion to how much of the tier each one beats
+int equilibriumbot(const struct boT *bot, const struct rounD *r, struct rnG *rng){
+
+    (void)bot;
+    return weightedpick(r->t, &r->g->share[r->g->seat[r->side]][r->g->draw[r->round]], r->balance, rng);
+}
+
+//Moves of a side in a tier: buying nothing first, then every affordable row in tier order
+int moves(const struct tieR *t, int budget, int *out){
+
+    int n = 0;
+    out[n++] = -1;
+    int b = breakpoint(t, budget);
+    if (b >= 0) {
+        const unsigned long long *set = t->afford + (size_t)b * t->words;
+        for (int k = 0; k < t->count; k++) {
+            if ((set[k / 64] >> (k % 64)) & 1) {
+                out[n++] = t->idx[k];
+            }
+        }
+    }
+    return n;
+}
+
+void arenakeys(){
+
+    pthread_key_create(&arenakey, arenadone);
+}
+
+//16-byte aligned bytes of the thread's current match, NULL with the arena unchanged
+//if a new block cannot be had
+void *arenaalloc(struct arenA *a, size_t size){
+
+    size = (size + 15) & ~(size_t)15;
+    if (a->base == NULL || a->used + size > a->cap) {
+        size_t cap = a->cap ? 2 * a->cap : 1 << 16;
+        while (cap < size + 16) cap *= 2;
+        char *block = malloc(cap);
+        if (block == NULL) {
+            return NULL;
+        }
+        //The first 16 bytes link the block to the one it replaces
+        memcpy(block, &a->base, sizeof(char *));
+        if (a->base == NULL) {
+            pthread_once(&arenaonce, arenakeys);
+            pthread_setspecific(arenakey, a);
+        }
+        a->base = block;
+        a->cap = cap;
+        a->used = 16;
+    }
+    void *p = a->base + a->used;
+    a->used += size;
+    a->live += size;
+    if (a->live > a->top) a->top = a->live;
+    return p;
+}
+
+//Hands back everything allocated after used in block, if the arena is still in it.
+//A NULL block was taken from an empty arena, so all of it goes back.
+void arenarelease(struct arenA *a, const char *block, size_t used){
+
+    if (block == NULL) {
+        arenareset(a);
+    } else if (a->base == block && a->used >= used) {
+        a->live -= a->used - used;
+        a->used = used;
+    }
+}
+
+//Empties the arena in O(1), keeping only its newest and largest block
+void arenareset(struct arenA *a){
+
+    if (a->top > a->peak) a->peak = a->top;
+    a->live = a->top = 0;
+    if (a->base == NULL) {
+        return;
+    }
+    char *old;
+    memcpy(&old, a->base, sizeof(char *));
+    while (old != NULL) {
+        char *next;
+        memcpy(&next, old, sizeof(char *));
+        free(old);
+        old = next;
+    }
+    old = NULL;
+    memcpy(a->base, &old, sizeof(char *));
+    a->used = 16;
+}
+
+//Thread exit: the arena's peak joins arenapeak and its blocks are freed
+void arenadone(void *arg){
+
+    struct arenA *a = arg;
+    arenareset(a);
+    pthread_mutex_lock(&arenalock);
+    if (a->peak > arenapeak) arenapeak = a->peak;
+    pthread_mutex_unlock(&arenalock);
+    free(a->base);
+    memset(a, 0, sizeof(*a));
+}
+
+//Most bytes a single match has held, over exited threads and this one
+size_t arenastat(){
+
+    arenareset(&arena);
+    pthread_mutex_lock(&arenalock);
+    size_t peak = arenapeak > arena.peak ? arenapeak : arena.peak;
+    pthread_mutex_unlock(&arenalock);
+    return peak;
+}
+
+//Search thread of mctsbot(), its arena only lives for one decision
+void *mctsthread(void *arg){
+
+    mctsworker(arg);
+    arenareset(&arena);
+    return NULL;
+}
+
+void *mctsworker(void *arg){
+
+    struct mctsjoB *job = arg;
+    const struct gamE *g = job->g;
+    int side = job->side;
+    struct rnG rng = {job->seed, 0};
+    struct rounD r;
+    //The tree goes back to the arena when the search ends
+    char *block = arena.base;
+    size_t mark = arena.used;
+    int *path = arenaalloc(&arena, (g->rounds + 1) * sizeof(int));
+    int maxtier = 0;
+    for (int p = 0; p < g->pools; p++) {
+        if (g->sides[g->seat[side]][p].count > maxtier) maxtier = g->sides[g->seat[side]][p].count;
+    }
+    int *act = arenaalloc(&arena, (maxtier + 1) * sizeof(int));
+
+    int cap = 1024, used = 1;
+    struct nodE *pool = arenaalloc(&arena, cap * sizeof(struct nodE));
+    if (path == NULL || act == NULL || pool == NULL) {
+        arenarelease(&arena, block, mark);
+        return NULL;
+    }
+    pool[0] = (struct nodE){-1, -1, 0, 0, 0};
+
+    //Without room for a bigger tree the search stops with what it has
+    for (int it = 0, full = 0; it < job->playouts && !full; it++) {
+        if ((it & 255) == 255 && now() > job->deadline) {
+            break;
+        }
+        //Restore the snapshot and walk down the tree
+        struct matcH m = job->root;
+        int n = 0, depth = 0;
+        path[depth++] = 0;
+        while (m.round < g->rounds) {
+            int c;
+            if (pool[n].first < 0) {
+                int kids = moves(seattier(g, side, m.round), m.blnc[side], act);
+                if (used + kids > cap) {
+                    int more = cap;
+                    while (used + kids > more) more *= 2;
+                    struct nodE *grown = arenaalloc(&arena, more * sizeof(struct nodE));
+                    if (grown == NULL) {
+                        full = 1;
+                        break;
+                    }
+                    memcpy(grown, pool, used * sizeof(struct nodE));
+                    pool = grown;
+                    cap = more;
+                }
+                pool[n].first = used;
+                pool[n].count = kids;
+                for (int k = 0; k < kids; k++) {
+                    pool[used++] = (struct nodE){act[k], -1, 0, 0, 0};
+                }
+                c = pool[n].first + rndint(&rng, kids);
+            } else {
+                //UCB1, unvisited children first
+                double best = -1;
+                c = pool[n].first;
+                double lnn = log((double)pool[n].visits + 1);
+                for (int k = pool[n].first; k < pool[n].first + pool[n].count; k++) {
+                    if (pool[k].visits == 0) {
+                        c = k;
+                        break;
+                    }
+                    double u = pool[k].wins / pool[k].visits + 1.4 * sqrt(lnn / pool[k].visits);
+                    if (u > best) {
+                        best = u;
+                        c = k;
+                    }
+                }
+            }
+            botview(g, &m, 1 - side, &r);
+            int opp = randombot(NULL, &r, &rng);
+            //Rewards make a balance depend on past outcomes too, a move the path can no
+            //longer pay for buys nothing
+            int own = pool[c].action;
+            if (own >= 0 && g->cat->price[own] > m.blnc[side]) {
+                own = -1;
+            }
+            if (side == 0) resolve(g, &m, own, opp); else resolve(g, &m, opp, own);
+            n = c;
+            path[depth++] = c;
+            if (pool[c].visits == 0) {
+                break;
+            }
+        }
+        //Random rollout for both sides to the end of the match
+        while (m.round < g->rounds) {
+            botview(g, &m, side, &r);
+            int own = randombot(NULL, &r, &rng);
+            botview(g, &m, 1 - side, &r);
+            int opp = randombot(NULL, &r, &rng);
+            if (side == 0) resolve(g, &m, own, opp); else resolve(g, &m, opp, own);
+        }
+        double result = m.score[side] > m.score[1 - side] ? 1 : m.score[side] == m.score[1 - side] ? 0.5 : 0;
+        for (int k = 0; k < depth; k++) {
+            pool[path[k]].visits++;
+            pool[path[k]].wins += result;
+        }
+    }
+
+    if (pool[0].first >= 0) {
+        for (int k = 0; k < pool[0].count; k++) {
+            job->visits[k] = pool[pool[0].first + k].visits;
+        }
+    }
+    arenarelease(&arena, block, mark);
+    return NULL;
+}
+
+//Root-parallel MCTS: every thread searches its own tree from the same snapshot and
+//the most visited root move over all trees is played
+int mctsbot(const struct boT *bot, const struct rounD *r, struct rnG *rng){
+
+    const struct mctS *conf = bot->ctx;
+    char *block = arena.base;
+    size_t mark = arena.used;
+    //Without memory for a search the bot buys greedily
+    int *act = arenaalloc(&arena, (r->t->count + 1) * sizeof(int));
+    if (act == NULL) {
+        return greedybot(bot, r, rng);
+    }
+    int kids = moves(r->t, r->balance, act);
+    if (kids == 1) {
+        arenarelease(&arena, block, mark);
+        return -1;
+    }
+
+    int threads = pooled ? 1 : cores();
+    struct mctsjoB *job = arenaalloc(&arena, threads * sizeof(struct mctsjoB));
+    pthread_t *tid = arenaalloc(&arena, threads * sizeof(pthread_t));
+    int *visits = arenaalloc(&arena, (size_t)threads * kids * sizeof(int));
+    if (job == NULL || tid == NULL || visits == NULL) {
+        arenarelease(&arena, block, mark);
+        return greedybot(bot, r, rng);
+    }
+    memset(visits, 0, (size_t)threads * kids * sizeof(int));
+    double deadline = now() + conf->ms / 1000.0;
+
+    for (int k = 0; k < threads; k++) {
+        job[k].g = r->g;
+        job[k].side = r->side;
+        job[k].root.round = r->round;
+        job[k].root.blnc[r->side] = r->balance;
+        job[k].root.blnc[1 - r->side] = r->opponent;
+        job[k].root.score[r->side] = r->won;
+        job[k].root.score[1 - r->side] = r->lost;
+        job[k].root.streak[r->side] = r->losses;
+        job[k].root.streak[1 - r->side] = r->opplosses;
+        job[k].playouts = conf->playouts / threads + (k < conf->playouts % threads);
+        job[k].deadline = deadline;
+        job[k].seed = rnd(rng);
+        job[k].visits = visits + (size_t)k * kids;
+    }
+    for (int k = 1; k < threads; k++) {
+        pthread_create(&tid[k], NULL, mctsthread, &job[k]);
+    }
+    mctsworker(&job[0]);
+    for (int k = 1; k < threads; k++) {
+        pthread_join(tid[k], NULL);
+    }
+
+    int best = 0;
+    long long most = -1;
+    for (int c = 0; c < kids; c++) {
+        long long sum = 0;
+        for (int k = 0; k < threads; k++) {
+            sum += visits[(size_t)k * kids + c];
+        }
+        if (sum > most) {
+            most = sum;
+            best = c;
+        }
+    }
+    int w = act[best];
+
+    arenarelease(&arena, block, mark);
+    return w;
+}
+
+//FNV-1a over what the engine reads, so saved data can tell which catalog it belongs to
+unsigned long long cataloghash(const struct gamE *g){
+
+    unsigned long long h = 0xcbf29ce484222325ULL;
+    for (int r = 0; r < TIERS; r++) {
+        const struct tieR *t = &g->tier[r];
+        for (int k = 0; k < t->count; k++) {
+            unsigned long long v[2];
+            //Rows both sides may buy hash as they did before the side column
+            unsigned side = (unsigned)(g->cat->side[t->idx[k]] ^ 3) << 28;
+            v[0] = (unsigned long long)g->cat->price[t->idx[k]] << 32 | (unsigned)t->idx[k] | side;
+            memcpy(&v[1], &g->score[t->idx[k]], sizeof(double));
+            const unsigned char *p = (const unsigned char *)v;
+            for (size_t b = 0; b < sizeof(v); b++) {
+                h = (h ^ p[b]) * 0x100000001b3ULL;
+            }
+        }
+        h = (h ^ (unsigned)t->count) * 0x100000001b3ULL;
+    }
+    //Classic data keeps the hashes it was saved with
+    if (g->eco != &economies[0]) {
+        const struct ecoN *e = g->eco;
+        int rule[STREAKS + TIERS + 5] = {e->income, e->start, e->win, e->carry, e->cap};
+        memcpy(rule + 5, e->loss, sizeof(e->loss));
+        memcpy(rule + 5 + STREAKS, e->kill, sizeof(e->kill));
+        for (size_t k = 0; k < sizeof(rule) / sizeof(int); k++) {
+            h = (h ^ (unsigned)rule[k]) * 0x100000001b3ULL;
+        }
+    }
+    //And so does the built-in schedule
+    if (!sched.builtin) {
+        h = (h ^ (unsigned)g->firstto) * 0x100000001b3ULL;
+        for (int r = 0; r < g->rounds; r++) {
+            h = (h ^ (unsigned)sched.mask[g->draw[r]]) * 0x100000001b3ULL;
+            h = (h ^ (unsigned)g->pay[r]) * 0x100000001b3ULL;
+        }
+    }
+    return h;
+}
+
+void newtable(const struct gamE *g, struct qtablE *qt){
+
+    const struct ecoN *e = g->eco;
+    long long top = e->start;
+    int actions = 0, reward = 0, bonus = 0;
+    for (int r = 0; r < g->rounds; r++) {
+        top += roundincome(g, r);
+    }
+    for (int p = 0; p < g->pools; p++) {
+        for (int s = 0; s < 2; s++) {
+            if (g->sides[s][p].count + 1 > actions) actions = g->sides[s][p].count + 1;
+        }
+    }
+    for (int k = 0; k < TIERS; k++) {
+        if (e->kill[k] > reward) reward = e->kill[k];
+    }
+    for (int k = 0; k < STREAKS; k++) {
+        if (e->loss[k] > bonus) bonus = e->loss[k];
+    }
+    top += (long long)(g->rounds - 1) * (e->win + reward > bonus ? e->win + reward : bonus);
+    if (e->cap > 0 && e->cap < top) {
+        top = e->cap;
+    }
+    //Long schedules get coarser buckets rather than a huge table
+    qt->rounds = 2 * g->rounds;
+    qt->bucket = 100;
+    while (top / qt->bucket > 200) {
+        qt->bucket *= 2;
+    }
+    qt->buckets = (int)(top / qt->bucket) + 1;
+    qt->scores = 2 * LEAD + 1;
+    qt->actions = actions;
+    qt->hash = cataloghash(g);
+    qt->q = calloc((size_t)qt->rounds * qt->buckets * qt->scores * qt->actions, sizeof(float));
+}
+
+//Action values of the seat side playing team (0 T, 1 CT) in the given state
+float *qrow(const struct qtablE *qt, const struct matcH *m, int side, int team){
+
+    int b = m->blnc[side] / qt->bucket;
+    if (b >= qt->buckets) b = qt->buckets - 1;
+    int s = m->score[side] - m->score[1 - side];
+    s = (s < -LEAD ? -LEAD : s > LEAD ? LEAD : s) + LEAD;
+    return qt->q + ((((size_t)team * (qt->rounds / 2) + m->round) * qt->buckets + b) * qt->scores + s) * qt->actions;
+}
+
+//Best legal action of a row, or a random legal one with probability epsilon
+int qchoose(const struct tieR *t, const float *row, int budget, double epsilon, struct rnG *rng){
+
+    int b = breakpoint(t, budget);
+    if (epsilon > 0 && rnd(rng) < epsilon * 18446744073709551616.0) {
+        int n = b < 0 ? 0 : affordcount(t, budget);
+        int pick = rndint(rng, n + 1);
+        if (pick == 0) {
+            return 0;
+        }
+        int row = affordpick(t, budget, rng);
+        for (int k = 0; k < t->count; k++) {
+            if (t->idx[k] == row) return k + 1;
+        }
+    }
+    int best = 0;
+    if (b >= 0) {
+        const unsigned long long *set = t->afford + (size_t)b * t->words;
+        for (int k = 0; k < t->count; k++) {
+            if (((set[k / 64] >> (k % 64)) & 1) && row[k + 1] > row[best]) {
+                best = k + 1;
+            }
+        }
+    }
+    return best;
+}
+
+//Plays the learned policy, or the greedy bot when no policy is loaded
+int qbot(const struct boT *bot, const struct rounD *r, struct rnG *rng){
+
+    const struct qtablE *qt = bot->ctx;
+    if (qt->q == NULL) {
+        return greedybot(bot, r, rng);
+    }
+    struct matcH m;
+    m.round = r->round;
+    m.blnc[0] = r->balance;
+    m.blnc[1] = r->opponent;
+    m.score[0] = r->won;
+    m.score[1] = r->lost;
+    m.streak[0] = r->losses;
+    m.streak[1] = r->opplosses;
+    int a = qchoose(r->t, qrow(qt, &m, 0, r->g->seat[r->side]), r->balance, 0, rng);
+    return a == 0 ? -1 : r->t->idx[a - 1];
+}
+
+//Q-learning episodes on a replica: reward 1 per round won, no discount
+void *trainworker(void *arg){
+
+    pooled = 1;
+    struct trainjoB *job = arg;
+    const struct gamE *g = job->g;
+    struct rnG rng = {job->seed, 0};
+    struct matcH m;
+    struct rounD r;
+
+    for (long long e = 0; e < job->episodes; e++) {
+        int side = e & 1;
+        newmatch(g, &m);
+        while (m.round < g->rounds) {
+            const struct tieR *t = seattier(g, side, m.round);
+            float *row = qrow(&job->qt, &m, side, g->seat[side]);
+            int a = qchoose(t, row, m.blnc[side], job->epsilon, &rng);
+            int own = a == 0 ? -1 : t->idx[a - 1];
+            botview(g, &m, 1 - side, &r);
+            int opp = job->opponent->pick(job->opponent, &r, &rng);
+            int win = side == 0 ? resolve(g, &m, own, opp) : resolve(g, &m, opp, own);
+            double target = win == side;
+            if (m.round < g->rounds) {
+                float *next = qrow(&job->qt, &m, side, g->seat[side]);
+                target += next[qchoose(seattier(g, side, m.round), next, m.blnc[side], 0, &rng)];
+            }
+            row[a] += job->alpha * (target - row[a]);
+        }
+    }
+    pooled = 0;
+    return NULL;
+}
+
+//ammo train [episodes] [file] [opponent]: replicas train in parallel and are averaged
+//into the master table after every epoch
+int train(int argc, char *argv[]){
+
+    long long episodes = argc > 2 ? atoll(argv[2]) : 10000000;
+    const char *file = argc > 3 ? argv[3] : "policy.bin";
+    const struct boT *opponent = findbot(argc > 4 ? argv[4] : "random");
+    if (opponent == NULL || opponent->pick == qbot) {
+        printf("Unknown opponent %s\n", argv[4]);
+        return 1;
+    }
+
+    int threads = cores();
+    const long long epoch = 100000;
+    struct qtablE master;
+    newtable(&game, &master);
+    size_t cells = (size_t)master.rounds * master.buckets * master.scores * master.actions;
+
+    struct trainjoB *job = malloc(threads * sizeof(struct trainjoB));
+    pthread_t *tid = malloc(threads * sizeof(pthread_t));
+    struct rnG rng = {(unsigned long long)time(NULL), 0};
+    for (int k = 0; k < threads; k++) {
+        job[k].g = &game;
+        job[k].opponent = opponent;
+        job[k].qt = master;
+        job[k].qt.q = malloc(cells * sizeof(float));
+        job[k].alpha = 0.05;
+    }
+
+    double start = now();
+    long long done = 0;
+    int epochs = (int)((episodes + epoch * threads - 1) / (epoch * threads));
+    for (int ep = 0; ep < epochs; ep++) {
+        //The last epoch plays what is left, its last thread takes the remainder
+        long long left = episodes - done < epoch * threads ? episodes - done : epoch * threads;
+        for (int k = 0; k < threads; k++) {
+            memcpy(job[k].qt.q, master.q, cells * sizeof(float));
+            job[k].episodes = k < threads - 1 ? left / threads : left - (threads - 1) * (left / threads);
+            job[k].epsilon = 0.3 * (1.0 - (double)ep / epochs) + 0.01;
+            job[k].seed = rnd(&rng);
+        }
+        for (int k = 1; k < threads; k++) {
+            pthread_create(&tid[k], NULL, trainworker, &job[k]);
+        }
+        trainworker(&job[0]);
+        for (int k = 1; k < threads; k++) {
+            pthread_join(tid[k], NULL);
+        }
+        //Merge the replicas, each weighted by the episodes it played
+        for (size_t c = 0; c < cells; c++) {
+            float sum = 0;
+            for (int k = 0; k < threads; k++) {
+                sum += job[k].qt.q[c] * job[k].episodes;
+            }
+            master.q[c] = sum / left;
+        }
+        done += left;
+    }
+    double secs = now() - start;
+
+    printf("%lld episodes against %s, %.0f episodes/s\n", done, opponent->name, secs > 0 ? done / secs : 0);
+    if (savepolicy(&master, file) != 0) {
+        printf("%s could not be written\n", file);
+        return 1;
+    }
+    printf("Policy saved to %s\n", file);
+
+    for (int k = 0; k < threads; k++) {
+        free(job[k].qt.q);
+    }
+    free(job);
+    free(tid);
+    free(master.q);
+    return 0;
+}
+
+//Binary policy: "FSQ1", five int dimensions, the catalog hash, then the floats
+int savepolicy(const struct qtablE *qt, const char *file){
+
+    FILE *fptr = fopen(file, "wb");
+    if (fptr == NULL) {
+        return -1;
+    }
+    int dim[5] = {qt->rounds, qt->buckets, qt->bucket, qt->scores, qt->actions};
+    size_t cells = (size_t)qt->rounds * qt->buckets * qt->scores * qt->actions;
+    fwrite("FSQ1", 1, 4, fptr);
+    fwrite(dim, sizeof(int), 5, fptr);
+    fwrite(&qt->hash, sizeof(qt->hash), 1, fptr);
+    size_t put = fwrite(qt->q, sizeof(float), cells, fptr);
+    fclose(fptr);
+    return put == cells ? 0 : -1;
+}
+
+//Loads a policy trained on this game. Without one the table is cleared, a policy of
+//another catalog, schedule or economy would play the wrong game.
+int loadpolicy(const struct gamE *g, struct qtablE *qt, const char *file){
+
+    FILE *fptr = fopen(file, "rb");
+    if (fptr == NULL) {
+        free(qt->q);
+        qt->q = NULL;
+        return -1;
+    }
+    char magic[4];
+    int dim[5];
+    unsigned long long hash;
+    if (fread(magic, 1, 4, fptr) != 4 || memcmp(magic, "FSQ1", 4) != 0
+        || fread(dim, sizeof(int), 5, fptr) != 5 || fread(&hash, sizeof(hash), 1, fptr) != 1
+        || hash != cataloghash(g) || dim[0] != 2 * g->rounds) {
+        fclose(fptr);
+        free(qt->q);
+        qt->q = NULL;
+        return -1;
+    }
+    size_t cells = (size_t)dim[0] * dim[1] * dim[3] * dim[4];
+    float *q = malloc(cells * sizeof(float));
+    if (fread(q, sizeof(float), cells, fptr) != cells) {
+        free(q);
+        fclose(fptr);
+        free(qt->q);
+        qt->q = NULL;
+        return -1;
+    }
+    fclose(fptr);
+
+    free(qt->q);
+    qt->rounds = dim[0];
+    qt->buckets = dim[1];
+    qt->bucket = dim[2];
+    qt->scores = dim[3];
+    qt->actions = dim[4];
+    qt->hash = hash;
+    qt->q = q;
+    return 0;
+}
+
+void newmatch(const struct gamE *g, struct matcH *m){
+
+    m->round = 0;
+    m->blnc[0] = m->blnc[1] = g->eco->start + roundincome(g, 0);
+    m->score[0] = m->score[1] = 0;
+    m->streak[0] = m->streak[1] = 0;
+}
+
+void botview(const struct gamE *g, const struct matcH *m, int side, struct rounD *r){
+
+    r->g = g;
+    r->t = seattier(g, side, m->round);
+    r->side = side;
+    r->round = m->round;
+    r->balance = m->blnc[side];
+    r->opponent = m->blnc[1 - side];
+    r->won = m->score[side];
+    r->lost = m->score[1 - side];
+    r->losses = m->streak[side];
+    r->opplosses = m->streak[1 - side];
+}
+
+//Both sides pay for their rows (-1 buys nothing), the higher balanced[] takes the
+//round and ties go to side 1 as in play(). Rewards and the next income follow the
+//economy, and a side reaching firstto ends the match. Returns the winning side, -1 for
+//an empty pool. settle() is the same for lanes.
+int resolve(const struct gamE *g, struct matcH *m, int a, int b){
+
+    const struct ecoN *e = g->eco;
+    int win = -1;
+    if (roundtier(g, m->round)->count > 0) {
+        int row[2] = {a, b};
+        double sa = a < 0 ? 0 : g->score[a];
+        double sb = b < 0 ? 0 : g->score[b];
+        win = !(sa > sb);
+        m->score[win]++;
+        for (int s = 0; s < 2; s++) {
+            m->blnc[s] -= row[s] < 0 ? 0 : g->cat->price[row[s]];
+            if (s == win) {
+                m->blnc[s] += e->win + g->kill[row[s] < 0 ? g->cat->count : row[s]];
+                m->streak[s] = 0;
+            } else {
+                m->blnc[s] += e->loss[m->streak[s] < STREAKS ? m->streak[s] : STREAKS - 1];
+                m->streak[s]++;
+            }
+        }
+    }
+    m->round++;
+    if (g->firstto > 0 && win >= 0 && m->score[win] >= g->firstto) {
+        m->round = g->rounds;
+    }
+    if (m->round < g->rounds) {
+        for (int s = 0; s < 2; s++) {
+            m->blnc[s] = m->blnc[s] * e->carry / 100 + roundincome(g, m->round);
+            if (e->cap > 0 && m->blnc[s] > e->cap) {
+                m->blnc[s] = e->cap;
+            }
+        }
+    }
+    return win;
+}
+
+//Lanes for cap matches in the thread's arena, they live until it is reset.
+//Returns -1 if the arena ran out.
+int newlanes(struct lanE *l, int cap){
+
+    for (int s = 0; s < 2; s++) {
+        l->pick[s] = arenaalloc(&arena, cap * sizeof(int));
+        l->cost[s] = arenaalloc(&arena, cap * sizeof(int));
+        l->gain[s] = arenaalloc(&arena, cap * sizeof(int));
+        l->bonus[s] = arenaalloc(&arena, cap * sizeof(int));
+        l->blnc[s] = arenaalloc(&arena, cap * sizeof(int));
+        l->streak[s] = arenaalloc(&arena, cap * sizeof(int));
+        l->score[s] = arenaalloc(&arena, cap * sizeof(int));
+        l->seat[s] = arenaalloc(&arena, cap * sizeof(struct rnG));
+    }
+    l->win = arenaalloc(&arena, cap * sizeof(int));
+    l->live = arenaalloc(&arena, cap * sizeof(int));
+    l->n = 0;
+    l->round = 0;
+    int ok = l->win != NULL && l->live != NULL;
+    for (int s = 0; s < 2; s++) {
+        ok = ok && l->pick[s] != NULL && l->cost[s] != NULL && l->gain[s] != NULL && l->bonus[s] != NULL;
+        ok = ok && l->blnc[s] != NULL && l->streak[s] != NULL && l->score[s] != NULL && l->seat[s] != NULL;
+    }
+    return ok ? 0 : -1;
+}
+
+//Starts n matches; seat streams are drawn lane by lane exactly as simmatch() draws them
+void startlanes(const struct gamE *g, struct lanE *l, int n, struct rnG *rng){
+
+    int start = g->eco->start + roundincome(g, 0);
+    l->n = n;
+    l->round = 0;
+    for (int i = 0; i < n; i++) {
+        for (int s = 0; s < 2; s++) {
+            l->seat[s][i].s = rnd(rng) ^ rng->flip;
+            l->seat[s][i].flip = rng->flip;
+            l->blnc[s][i] = start;
+            l->streak[s][i] = 0;
+            l->score[s][i] = 0;
+        }
+        l->live[i] = 1;
+    }
+}
+
+void laneview(const struct gamE *g, const struct lanE *l, int i, int side, struct rounD *r){
+
+    r->g = g;
+    r->t = seattier(g, side, l->round);
+    r->side = side;
+    r->round = l->round;
+    r->balance = l->blnc[side][i];
+    r->opponent = l->blnc[1 - side][i];
+    r->won = l->score[side][i];
+    r->lost = l->score[1 - side][i];
+    r->losses = l->streak[side][i];
+    r->opplosses = l->streak[1 - side][i];
+}
+
+//resolve() for every lane at once on the picks in l->pick. The table lookups are
+//gathered in one pass, the money updates are plain loops over the lane arrays.
+void settle(const struct gamE *g, struct lanE *l){
+
+    const struct ecoN *e = g->eco;
+    int n = l->n, none = g->cat->count;
+
+    if (roundtier(g, l->round)->count > 0) {
+        for (int i = 0; i < n; i++) {
+            int a = l->pick[0][i], b = l->pick[1][i];
+            double sa = a < 0 ? 0 : g->score[a];
+            double sb = b < 0 ? 0 : g->score[b];
+            l->win[i] = !(sa > sb);
+            l->cost[0][i] = a < 0 ? 0 : g->cat->price[a];
+            l->cost[1][i] = b < 0 ? 0 : g->cat->price[b];
+            l->gain[0][i] = g->kill[a < 0 ? none : a];
+            l->gain[1][i] = g->kill[b < 0 ? none : b];
+        }
+        for (int s = 0; s < 2; s++) {
+            const int *win = l->win, *cost = l->cost[s], *gain = l->gain[s], *live = l->live;
+            int *blnc = l->blnc[s], *streak = l->streak[s], *score = l->score[s], *bonus = l->bonus[s];
+            for (int i = 0; i < n; i++) {
+                bonus[i] = e->loss[streak[i] < STREAKS ? streak[i] : STREAKS - 1];
+            }
+            for (int i = 0; i < n; i++) {
+                int won = win[i] == s;
+                blnc[i] += (won ? e->win + gain[i] : bonus[i]) - cost[i];
+                score[i] += won & live[i];
+                streak[i] = won ? 0 : streak[i] + 1;
+            }
+        }
+        //Lanes whose match is decided keep stepping but no longer score
+        if (g->firstto > 0) {
+            const int *s0 = l->score[0], *s1 = l->score[1];
+            for (int i = 0; i < n; i++) {
+                l->live[i] = s0[i] < g->firstto && s1[i] < g->firstto;
+            }
+        }
+    }
+
+    l->round++;
+    if (l->round < g->rounds) {
+        int paid = roundincome(g, l->round), cap = e->cap > 0 ? e->cap : 0x7fffffff;
+        for (int s = 0; s < 2; s++) {
+            int *blnc = l->blnc[s];
+            if (e->carry != 100) {
+                for (int i = 0; i < n; i++) {
+                    blnc[i] = blnc[i] * e->carry / 100;
+                }
+            }
+            for (int i = 0; i < n; i++) {
+                blnc[i] = blnc[i] + paid < cap ? blnc[i] + paid : cap;
+            }
+        }
+    }
+}
+
+//Plays a whole match headless, returns the winning side or 2 for a draw
+int simmatch(const struct gamE *g, const struct boT *a, const struct boT *b, struct rnG *rng, struct tallY *tally){
+
+    struct matcH m;
+    struct rounD r;
+    //Each seat draws from its own stream, so one side's picks never shift the other's
+    struct rnG seat[2] = {{rnd(rng) ^ rng->flip, rng->flip}, {rnd(rng) ^ rng->flip, rng->flip}};
+    //What the match takes from the arena goes back at its end, the caller's part stays
+    char *block = arena.base;
+    size_t mark = arena.used;
+
+    newmatch(g, &m);
+    while (m.round < g->rounds) {
+        botview(g, &m, 0, &r);
+        int wa = a->pick(a, &r, &seat[0]);
+        botview(g, &m, 1, &r);
+        int wb = b->pick(b, &r, &seat[1]);
+        int win = resolve(g, &m, wa, wb);
+        if (tally != NULL && win >= 0) {
+            if (wa >= 0) {
+                tally->picked[wa]++;
+                tally->won[wa] += win == 0;
+            }
+            if (wb >= 0) {
+                tally->picked[wb]++;
+                tally->won[wb] += win == 1;
+            }
+        }
+    }
+    arenarelease(&arena, block, mark);
+    return m.score[0] > m.score[1] ? 0 : m.score[1] > m.score[0] ? 1 : 2;
+}
+
+//Match i of a series, seats alternate so ties do not favour either bot.
+//Returns 0 if a won, 1 if b won and 2 for a draw.
+int seatmatch(const struct gamE *g, const struct boT *a, const struct boT *b, long long i, struct rnG *rng, struct tallY *tally){
+
+    if ((i & 1) == 0) {
+        return simmatch(g, a, b, rng, tally);
+    }
+    int w = simmatch(g, b, a, rng, tally);
+    return w < 2 ? 1 - w : w;
+}
+
+void newteam(const struct gamE *g, struct teaM *m){
+
+    m->round = 0;
+    for (int p = 0; p < TEAM; p++) {
+        m->blnc[0][p] = m->blnc[1][p] = g->eco->start + roundincome(g, 0);
+    }
+    m->score[0] = m->score[1] = 0;
+    m->streak[0] = m->streak[1] = 0;
+}
+
+//A player sees their own balance and the one of the enemy in the same slot
+void teamview(const struct gamE *g, const struct teaM *m, int side, int player, struct rounD *r){
+
+    r->g = g;
+    r->t = seattier(g, side, m->round);
+    r->side = side;
+    r->round = m->round;
+    r->balance = m->blnc[side][player];
+    r->opponent = m->blnc[1 - side][player];
+    r->won = m->score[side];
+    r->lost = m->score[1 - side];
+    r->losses = m->streak[side];
+    r->opplosses = m->streak[1 - side];
+}
+
+//n duels at once, row a[i] against b[i]: the higher balanced[] wins and a tie goes to
+//bit i of coin. win[i] is the winning side.
+void duels(const struct gamE *g, int n, const int *a, const int *b, unsigned long long coin, int *win){
+
+    for (int i = 0; i < n; i++) {
+        double sa = a[i] < 0 ? 0 : g->score[a[i]];
+        double sb = b[i] < 0 ? 0 : g->score[b[i]];
+        win[i] = sa > sb ? 0 : sb > sa ? 1 : (int)(coin >> i & 1);
+    }
+}
+
+//Plays a 5v5 round on the buys of every player (-1 buys nothing). Survivors are paired
+//up in waves against a random rotation of the other side, every wave is one duels()
+//call, until one side is eliminated. Each duel won is a kill worth its weapon's
+//reward; the side rewards and the next income follow the economy as in resolve().
+//Returns the winning side, -1 for an empty tier. kills may be NULL.
+int teamround(const struct gamE *g, struct teaM *m, int buy[2][TEAM], struct rnG *rng, int kills[2][TEAM]){
+
+    const struct ecoN *e = g->eco;
+    int win = -1, count[2][TEAM];
+    memset(count, 0, sizeof(count));
+
+    if (roundtier(g, m->round)->count > 0) {
+        int live[2][TEAM], n[2] = {TEAM, TEAM};
+        for (int s = 0; s < 2; s++) {
+            for (int p = 0; p < TEAM; p++) {
+                live[s][p] = p;
+                m->blnc[s][p] -= buy[s][p] < 0 ? 0 : g->cat->price[buy[s][p]];
+            }
+        }
+        while (n[0] > 0 && n[1] > 0) {
+            int k = n[0] < n[1] ? n[0] : n[1], off = rndint(rng, n[1]);
+            int a[TEAM], b[TEAM], who[TEAM], won[TEAM];
+            for (int i = 0; i < k; i++) {
+                who[i] = live[1][(i + off) % n[1]];
+                a[i] = buy[0][live[0][i]];
+                b[i] = buy[1][who[i]];
+            }
+            duels(g, k, a, b, rnd(rng), won);
+            //Losers drop out, the survivors keep their order
+            int dead[2][TEAM];
+            memset(dead, 0, sizeof(dead));
+            for (int i = 0; i < k; i++) {
+                int p[2] = {live[0][i], who[i]};
+                count[won[i]][p[won[i]]]++;
+                dead[1 - won[i]][p[1 - won[i]]] = 1;
+            }
+            for (int s = 0; s < 2; s++) {
+                int left = 0;
+                for (int i = 0; i < n[s]; i++) {
+                    if (!dead[s][live[s][i]]) live[s][left++] = live[s][i];
+                }
+                n[s] = left;
+            }
+        }
+        win = n[0] > 0 ? 0 : 1;
+        m->score[win]++;
+        int bonus = e->loss[m->streak[1 - win] < STREAKS ? m->streak[1 - win] : STREAKS - 1];
+        for (int s = 0; s < 2; s++) {
+            for (int p = 0; p < TEAM; p++) {
+                m->blnc[s][p] += s == win ? e->win : bonus;
+                m->blnc[s][p] += count[s][p] * g->kill[buy[s][p] < 0 ? g->cat->count : buy[s][p]];
+            }
+        }
+        m->streak[win] = 0;
+        m->streak[1 - win]++;
+    }
+    m->round++;
+    if (g->firstto > 0 && win >= 0 && m->score[win] >= g->firstto) {
+        m->round = g->rounds;
+    }
+    if (m->round < g->rounds) {
+        for (int s = 0; s < 2; s++) {
+            for (int p = 0; p < TEAM; p++) {
+                m->blnc[s][p] = m->blnc[s][p] * e->carry / 100 + roundincome(g, m->round);
+                if (e->cap > 0 && m->blnc[s][p] > e->cap) {
+                    m->blnc[s][p] = e->cap;
+                }
+            }
+        }
+    }
+    if (kills != NULL) {
+        memcpy(kills, count, sizeof(count));
+    }
+    return win;
+}
+
+//A whole 5v5 match headless, every player of a side buys with its bot on the side's
+//stream and the waves draw from a third one. Returns the winning side or 2 for a draw.
+//With a tape every round is also recorded on it.
+int teammatch(const struct gamE *g, const struct boT *a, const struct boT *b, struct rnG *rng, struct tallY *tally,
+              struct tapE *tape){
+
+    struct teaM m;
+    struct rounD r;
+    struct rnG seat[3];
+    const struct boT *bot[2] = {a, b};
+    int buy[2][TEAM];
+    char *block = arena.base;
+    size_t mark = arena.used;
+    for (int s = 0; s < 3; s++) {
+        seat[s].s = rnd(rng) ^ rng->flip;
+        seat[s].flip = rng->flip;
+    }
+
+    newteam(g, &m);
+    while (m.round < g->rounds) {
+        for (int s = 0; s < 2; s++) {
+            for (int p = 0; p < TEAM; p++) {
+                teamview(g, &m, s, p, &r);
+                buy[s][p] = bot[s]->pick(bot[s], &r, &seat[s]);
+            }
+        }
+        int blnc[2 * TEAM];
+        memcpy(blnc, m.blnc, sizeof(blnc));
+        int win = teamround(g, &m, buy, &seat[2], NULL);
+        if (tape != NULL) {
+            taperound(tape, &buy[0][0], blnc, win);
+        }
+        for (int s = 0; tally != NULL && win >= 0 && s < 2; s++) {
+            for (int p = 0; p < TEAM; p++) {
+                if (buy[s][p] >= 0) {
+                    tally->picked[buy[s][p]]++;
+                    tally->won[buy[s][p]] += win == s;
+                }
+            }
+        }
+    }
+    arenarelease(&arena, block, mark);
+    return m.score[0] > m.score[1] ? 0 : m.score[1] > m.score[0] ? 1 : 2;
+}
+
+//Wilson score interval of a rate p observed over n trials
+void wilson(double p, double n, double z, double *lo, double *hi){
+
+    if (n <= 0) {
+        *lo = 0;
+        *hi = 1;
+        return;
+    }
+    double z2 = z * z / n;
+    double mid = (p + z2 / 2) / (1 + z2);
+    double half = z * sqrt(p * (1 - p) / n + z2 / (4 * n)) / (1 + z2);
+    *lo = mid - half < 0 ? 0 : mid - half;
+    *hi = mid + half > 1 ? 1 : mid + half;
+}
+
+//Elo difference that predicts a score rate p, clamped to +-1200
+double elogap(double p){
+
+    if (p < 0.001) p = 0.001;
+    if (p > 0.999) p = 0.999;
+    return -400 * log10(1 / p - 1);
+}
+
+//Bradley-Terry ratings from every pairing's total score, solved by Zermelo's
+//iteration and centred on 1500. Scores are clamped as in elogap(), so two bots end
+//exactly elogap(score) apart.
+void fitratings(struct leaguE *l){
+
+    double gamma[BOTS], won[BOTS];
+    for (int k = 0; k < l->n; k++) {
+        gamma[k] = 1;
+        won[k] = 0;
+    }
+    for (int k = 0; k < l->pairs; k++) {
+        const struct paiR *p = &l->pair[k];
+        if (p->games > 0) {
+            double s = p->points / p->games;
+            s = s < 0.001 ? 0.001 : s > 0.999 ? 0.999 : s;
+            won[p->a] += s * p->games;
+            won[p->b] += (1 - s) * p->games;
+        }
+    }
+    for (int it = 0; it < 10000; it++) {
+        double step = 0, sum = 0;
+        for (int i = 0; i < l->n; i++) {
+            double d = 0;
+            for (int k = 0; k < l->pairs; k++) {
+                const struct paiR *p = &l->pair[k];
+                if (p->games > 0 && (p->a == i || p->b == i)) {
+                    d += p->games / (gamma[p->a] + gamma[p->b]);
+                }
+            }
+            if (d > 0) {
+                double next = won[i] / d;
+                step = fmax(step, fabs(log(next / gamma[i])));
+                gamma[i] = next;
+            }
+        }
+        //Only the ratios matter, the scale is kept at a geometric mean of 1
+        for (int i = 0; i < l->n; i++) {
+            sum += log(gamma[i]);
+        }
+        for (int i = 0; i < l->n; i++) {
+            gamma[i] = exp(log(gamma[i]) - sum / l->n);
+        }
+        if (step < 1e-12) {
+            break;
+        }
+    }
+    for (int i = 0; i < l->n; i++) {
+        l->rating[i] = 1500 + 400 * log10(gamma[i]);
+    }
+}
+
+//Takes free pairings and plays them in batches. The ratings are fitted again from
+//all scores whenever a pairing stops, which happens once the Elo interval implied
+//by its 95% Wilson interval is within +-elo or it reaches maxgames.
+void *leagueworker(void *arg){
+
+    pooled = 1;
+    struct leaguE *l = arg;
+
+    pthread_mutex_lock(&l->lock);
+    struct rnG rng = {l->seed, 0};
+    l->seed = rnd(&rng);
+    while (1) {
+        struct paiR *p = NULL;
+        for (int k = 0; k < l->pairs; k++) {
+            if (!l->pair[k].done && !l->pair[k].busy) {
+                p = &l->pair[k];
+                break;
+            }
+        }
+        if (p == NULL) {
+            break;
+        }
+        p->busy = 1;
+        while (!p->done) {
+            long long first = p->games;
+            pthread_mutex_unlock(&l->lock);
+
+            double points = 0;
+            for (int i = 0; i < l->batch; i++) {
+                int w = seatmatch(&game, l->bot[p->a], l->bot[p->b], first + i, &rng, NULL);
+                points += w == 0 ? 1 : w == 2 ? 0.5 : 0;
+            }
+
+            pthread_mutex_lock(&l->lock);
+            p->games += l->batch;
+            p->points += points;
+            double lo, hi;
+            wilson(p->points / p->games, p->games, 1.96, &lo, &hi);
+            if (elogap(hi) - elogap(lo) <= 2 * l->elo || p->games >= l->maxgames) {
+                p->done = 1;
+                fitratings(l);
+                saveleague(l);
+            }
+        }
+        p->busy = 0;
+    }
+    pthread_mutex_unlock(&l->lock);
+    pooled = 0;
+    return NULL;
+}
+
+//ammo league [checkpoint] [bot ...]: round robin of every pair, all bots but mcts by default
+int league(int argc, char *argv[]){
+
+    static struct leaguE l;
+    double v;
+
+    l.maxgames = flag(&argc, argv, "--games", &v) ? (long long)v : 100000;
+    l.elo = flag(&argc, argv, "--elo", &v) ? v : 10;
+    l.batch = 500;
+    l.file = argc > 2 ? argv[2] : "league.txt";
+    l.n = 0;
+    if (argc > 3) {
+        for (int i = 3; i < argc && l.n < BOTS; i++) {
+            if ((l.bot[l.n] = findbot(argv[i])) == NULL) {
+                printf("Unknown bot %s\n", argv[i]);
+                return 1;
+            }
+            l.n++;
+        }
+    } else {
+        for (int b = 0; b < BOTS; b++) {
+            if (bots[b].pick != mctsbot) {
+                l.bot[l.n++] = &bots[b];
+            }
+        }
+    }
+
+    l.pairs = 0;
+    for (int a = 0; a < l.n; a++) {
+        l.rating[a] = 1500;
+        for (int b = a + 1; b < l.n; b++) {
+            l.pair[l.pairs++] = (struct paiR){a, b, 0, 0, 0, 0};
+        }
+    }
+    int resumed = loadleague(&l);
+    if (resumed == 0) {
+        printf("Resuming from %s\n", l.file);
+    } else if (resumed == -2) {
+        printf("%s is not a checkpoint of this league, starting over\n", l.file);
+    }
+    l.seed = (unsigned long long)time(NULL);
+    pthread_mutex_init(&l.lock, NULL);
+
+    int threads = cores();
+    pthread_t *tid = malloc(threads * sizeof(pthread_t));
+    double start = now();
+    for (int k = 1; k < threads; k++) {
+        pthread_create(&tid[k], NULL, leagueworker, &l);
+    }
+    leagueworker(&l);
+    for (int k = 1; k < threads; k++) {
+        pthread_join(tid[k], NULL);
+    }
+    double secs = now() - start;
+    free(tid);
+    fitratings(&l);
+
+    //Rating table, best first
+    int rank[BOTS];
+    long long games[BOTS] = {0}, total = 0;
+    for (int k = 0; k < l.n; k++) {
+        rank[k] = k;
+    }
+    for (int k = 0; k < l.pairs; k++) {
+        games[l.pair[k].a] += l.pair[k].games;
+        games[l.pair[k].b] += l.pair[k].games;
+        total += l.pair[k].games;
+    }
+    for (int i = 1; i < l.n; i++) {
+        for (int j = i; j > 0 && l.rating[rank[j]] > l.rating[rank[j - 1]]; j--) {
+            int s = rank[j];
+            rank[j] = rank[j - 1];
+            rank[j - 1] = s;
+        }
+    }
+    printf("|----|------------|-------|---------|\n");
+    printf("|Rank|Bot         |Elo    |Games    |\n");
+    printf("|----|------------|-------|---------|\n");
+    for (int i = 0; i < l.n; i++) {
+        printf("|%4d|%-12s|%7.1f|%9lld|\n", i + 1, l.bot[rank[i]]->name, l.rating[rank[i]], games[rank[i]]);
+    }
+    printf("|----|------------|-------|---------|\n");
+    printf("%lld games in %.1f s\n", total, secs);
+
+    pthread_mutex_destroy(&l.lock);
+    return saveleague(&l) == 0 ? 0 : 1;
+}
+
+//Text checkpoint: the bots with their ratings, then one line per pairing
+int saveleague(const struct leaguE *l){
+
+    FILE *fptr = fopen(l->file, "w");
+    if (fptr == NULL) {
+        return -1;
+    }
+    fprintf(fptr, "firesync-league 1 %d %d\n", l->n, l->pairs);
+    for (int k = 0; k < l->n; k++) {
+        fprintf(fptr, "%s %.17g\n", l->bot[k]->name, l->rating[k]);
+    }
+    for (int k = 0; k < l->pairs; k++) {
+        const struct paiR *p = &l->pair[k];
+        fprintf(fptr, "%d %d %lld %.17g %d\n", p->a, p->b, p->games, p->points, p->done);
+    }
+    fclose(fptr);
+    return 0;
+}
+
+//Resumes a checkpoint written for the same list of bots. Returns -1 without a file and
+//-2 for a file of another league or with pairings it could not have played.
+int loadleague(struct leaguE *l){
+
+    FILE *fptr = fopen(l->file, "r");
+    if (fptr == NULL) {
+        return -1;
+    }
+    int n, pairs, ok = 1;
+    char name[64];
+    double rating[BOTS];
+    struct paiR pair[BOTS * BOTS];
+    if (fscanf(fptr, "firesync-league 1 %d %d", &n, &pairs) != 2 || n != l->n || pairs != l->pairs) {
+        ok = 0;
+    }
+    for (int k = 0; ok && k < n; k++) {
+        ok = fscanf(fptr, "%63s %lf", name, &rating[k]) == 2 && strcmp(name, l->bot[k]->name) == 0;
+    }
+    //Pairings must come in this league's order, each with a count and score it could have played
+    for (int k = 0; ok && k < pairs; k++) {
+        pair[k].busy = 0;
+        ok = fscanf(fptr, "%d %d %lld %lf %d", &pair[k].a, &pair[k].b, &pair[k].games, &pair[k].points, &pair[k].done) == 5;
+        ok = ok && pair[k].a == l->pair[k].a && pair[k].b == l->pair[k].b;
+        ok = ok && pair[k].games >= 0 && pair[k].points >= 0 && pair[k].points <= pair[k].games;
+        ok = ok && (pair[k].done == 0 || pair[k].done == 1);
+    }
+    fclose(fptr);
+    if (!ok) {
+        return -2;
+    }
+    memcpy(l->rating, rating, n * sizeof(double));
+    memcpy(l->pair, pair, pairs * sizeof(struct paiR));
+    return 0;
+}
+
+//Inverse of the standard normal CDF (Acklam), good to about 1e-9
+double probit(double p){
+
+    const double a[6] = {-3.969683028665376e+01, 2.209460984245205e+02, -2.759285104469687e+02,
+                         1.383577518672690e+02, -3.066479806614716e+01, 2.506628277459239e+00};
+    const double b[5] = {-5.447609879822406e+01, 1.615858368580409e+02, -1.556989798598866e+02,
+                         6.680131188771972e+01, -1.328068155288572e+01};
+    const double c[6] = {-7.784894002430293e-03, -3.223964580411365e-01, -2.400758277161838e+00,
+                         -2.549732539343734e+00, 4.374664141464968e+00, 2.938163982698783e+00};
+    const double d[4] = {7.784695709041462e-03, 3.224671290700398e-01, 2.445134137142996e+00,
+                         3.754408661907416e+00};
+
+    if (p < 0.02425) {
+        double q = sqrt(-2 * log(p));
+        return (((((c[0] * q + c[1]) * q + c[2]) * q + c[3]) * q + c[4]) * q + c[5]) /
+               ((((d[0] * q + d[1]) * q + d[2]) * q + d[3]) * q + 1);
+    }
+    if (p > 1 - 0.02425) {
+        return -probit(1 - p);
+    }
+    double q = p - 0.5, r = q * q;
+    return (((((a[0] * r + a[1]) * r + a[2]) * r + a[3]) * r + a[4]) * r + a[5]) * q /
+           (((((b[0] * r + b[1]) * r + b[2]) * r + b[3]) * r + b[4]) * r + 1);
+}
+
+void *simworker(void *arg){
+
+    pooled = 1;
+    struct simjoB *job = arg;
+    const struct gamE *g = job->g;
+    int n = g->cat->count;
+    struct tallY tally;
+    tally.picked = calloc(n + 1, sizeof(long long));
+    tally.won = calloc(n + 1, sizeof(long long));
+    struct lanE lanes;
+    struct rounD r;
+    int players = job->team ? TEAM : 1;
+
+    for (;;) {
+        //The batch's lanes and a recorded batch's encoding live in the arena until the
+        //next batch; the encoding waits there for its turn to be appended. A batch is
+        //only taken once they fit, so no later batch waits on one that was never played.
+        arenareset(&arena);
+        int *rec = NULL;
+        unsigned char *chunk = NULL;
+        size_t *size = NULL;
+        int ok = job->team || newlanes(&lanes, job->batch) == 0;
+        if (job->record != NULL) {
+            rec = job->team ? NULL : arenaalloc(&arena, (size_t)job->batch * g->rounds * 5 * sizeof(int));
+            chunk = arenaalloc(&arena, (size_t)job->batch * tapebound(players, g->rounds));
+            size = arenaalloc(&arena, job->batch * sizeof(size_t));
+            ok = ok && (job->team || rec != NULL) && chunk != NULL && size != NULL;
+        }
+        pthread_mutex_lock(&job->lock);
+        if (!ok) {
+            job->stop = 4;
+        }
+        if (job->stop || job->next * job->batch >= job->matches) {
+            break;
+        }
+        long long id = job->next++;
+        pthread_mutex_unlock(&job->lock);
+
+        //Each batch has its own stream, so a fixed-size run does not depend on the thread count
+        long long first = id * job->batch;
+        long long last = first + job->batch < job->matches ? first + job->batch : job->matches;
+        struct rnG rng = {job->seed + (unsigned long long)id * 0xd1b54a32d192ed03ULL, 0};
+        long long won[3] = {0, 0, 0};
+        if (job->team) {
+            //Team matches alternate seats as seatmatch() does
+            size_t at = 0;
+            for (long long i = first; i < last; i++) {
+                struct tapE tape, *t = NULL;
+                if (chunk != NULL) {
+                    tapebegin(&tape, chunk + at, TEAM, g->seat[0]);
+                    t = &tape;
+                }
+                int w = (i & 1) == 0 ? teammatch(g, job->a, job->b, &rng, &tally, t) : teammatch(g, job->b, job->a, &rng, &tally, t);
+                won[w < 2 && (i & 1) ? 1 - w : w]++;
+                if (chunk != NULL) {
+                    size[i - first] = tapeend(&tape);
+                    at += size[i - first];
+                }
+            }
+        } else {
+            //The batch plays as seatmatch() would play it match by match, a round at a time
+            startlanes(g, &lanes, (int)(last - first), &rng);
+            while (lanes.round < g->rounds) {
+                for (int i = 0; i < lanes.n; i++) {
+                    int odd = (first + i) & 1;
+                    for (int s = 0; s < 2; s++) {
+                        const struct boT *bot = s == odd ? job->a : job->b;
+                        laneview(g, &lanes, i, s, &r);
+                        lanes.pick[s][i] = lanes.live[i] ? bot->pick(bot, &r, &lanes.seat[s][i]) : -1;
+                    }
+                }
+                int round = lanes.round;
+                for (int i = 0; rec != NULL && i < lanes.n; i++) {
+                    int *e = rec + ((size_t)round * lanes.n + i) * 5;
+                    e[0] = lanes.pick[0][i];
+                    e[1] = lanes.pick[1][i];
+                    e[2] = lanes.blnc[0][i];
+                    e[3] = lanes.blnc[1][i];
+                    e[4] = lanes.live[i];
+                }
+                settle(g, &lanes);
+                for (int i = 0; rec != NULL && i < lanes.n; i++) {
+                    int *e = rec + ((size_t)round * lanes.n + i) * 5;
+                    e[4] = !e[4] ? -1 : roundtier(g, round)->count > 0 ? lanes.win[i] : 2;
+                }
+                for (int i = 0; roundtier(g, round)->count > 0 && i < lanes.n; i++) {
+                    for (int s = 0; s < 2; s++) {
+                        int j = lanes.pick[s][i];
+                        if (j >= 0) {
+                            tally.picked[j]++;
+                            tally.won[j] += lanes.win[i] == s;
+                        }
+                    }
+                }
+            }
+            for (int i = 0, at = 0; rec != NULL && i < lanes.n; i++) {
+                struct tapE tape;
+                tapebegin(&tape, chunk + at, 1, g->seat[0]);
+                for (int k = 0; k < g->rounds; k++) {
+                    int *e = rec + ((size_t)k * lanes.n + i) * 5;
+                    if (e[4] >= 0) {
+                        taperound(&tape, e, e + 2, e[4]);
+                    }
+                }
+                size[i] = tapeend(&tape);
+                at += size[i];
+            }
+            for (int i = 0; i < lanes.n; i++) {
+                int s0 = lanes.score[0][i], s1 = lanes.score[1][i];
+                int w = s0 > s1 ? 0 : s1 > s0 ? 1 : 2;
+                won[w < 2 && ((first + i) & 1) ? 1 - w : w]++;
+            }
+        }
+
+        pthread_mutex_lock(&job->lock);
+        if (job->record != NULL) {
+            while (job->flushed != id) {
+                pthread_cond_wait(&job->order, &job->lock);
+            }
+            for (long long i = 0, at = 0; i < last - first; at += size[i++]) {
+                replaymatch(job->record, chunk + at, size[i]);
+            }
+            job->flushed++;
+            pthread_cond_broadcast(&job->order);
+        }
+        for (int k = 0; k < 3; k++) {
+            job->won[k] += won[k];
+        }
+        job->played += last - first;
+        if (job->played >= job->matches) {
+            job->stop = 3;
+        }
+        double p = (job->won[0] + 0.5 * job->won[2]) / job->played, lo, hi;
+        if (job->precision > 0) {
+            wilson(p, job->played, 1.96, &lo, &hi);
+            if ((hi - lo) / 2 <= job->precision) {
+                job->stop = 1;
+            }
+        }
+        //Look k spends alpha / (k (k + 1)), the looks together never spend more than alpha
+        if (job->alpha > 0) {
+            job->looks++;
+            double spend = job->alpha / ((double)job->looks * (job->looks + 1));
+            wilson(p, job->played, probit(1 - spend / 2), &lo, &hi);
+            if (lo > 0.5 || hi < 0.5) {
+                job->stop = 2;
+            }
+        }
+        pthread_mutex_unlock(&job->lock);
+    }
+    for (int j = 0; j < n; j++) {
+        job->tally.picked[j] += tally.picked[j];
+        job->tally.won[j] += tally.won[j];
+    }
+    pthread_mutex_unlock(&job->lock);
+
+    free(tally.picked);
+    free(tally.won);
+    pooled = 0;
+    return NULL;
+}
+
+//ammo sim <bot> <bot> [matches] [seed], optionally stopping early once the score
+//interval is within --precision or the score differs from 50% at level --alpha.
+//ammo team plays the same run as 5v5 matches. --record file logs every match.
+int simulate(int argc, char *argv[]){
+
+    static struct simjoB job;
+    static struct replaY out;
+    double v;
+    const char *record = NULL;
+
+    job.precision = flag(&argc, argv, "--precision", &v) ? v : 0;
+    job.alpha = flag(&argc, argv, "--alpha", &v) ? v : 0;
+    job.batch = flag(&argc, argv, "--batch", &v) ? (int)v : 4096;
+    textflag(&argc, argv, "--record", &record);
+    if (argc < 4) {
+        printf("Usage: %s %s <bot> <bot> [matches] [seed] [--precision h] [--alpha a] [--record file]\n", argv[0], argv[1]);
+        return 1;
+    }
+    job.team = strcmp(argv[1], "team") == 0;
+    job.a = findbot(argv[2]);
+    job.b = findbot(argv[3]);
+    if (job.a == NULL || job.b == NULL) {
+        printf("Unknown bot %s\n", job.a == NULL ? argv[2] : argv[3]);
+        return 1;
+    }
+    job.g = &game;
+    job.matches = argc > 4 ? atoll(argv[4]) : (job.precision > 0 || job.alpha > 0 ? 100000000 : 100000);
+    job.seed = argc > 5 ? strtoull(argv[5], NULL, 10) : (unsigned long long)time(NULL);
+    job.tally.picked = calloc(game.cat->count + 1, sizeof(long long));
+    job.tally.won = calloc(game.cat->count + 1, sizeof(long long));
+    if (record != NULL) {
+        if (replayopen(&out, record, job.team ? TEAM : 1, job.batch, job.seed, cataloghash(&game), job.a->name,
+                       job.b->name, 0) < 0) {
+            printf("Cannot write %s\n", record);
+            return 1;
+        }
+        job.record = &out;
+    }
+    pthread_mutex_init(&job.lock, NULL);
+    pthread_cond_init(&job.order, NULL);
+
+    int threads = cores();
+    pthread_t *tid = malloc(threads * sizeof(pthread_t));
+    double start = now();
+    for (int k = 1; k < threads; k++) {
+        pthread_create(&tid[k], NULL, simworker, &job);
+    }
+    simworker(&job);
+    for (int k = 1; k < threads; k++) {
+        pthread_join(tid[k], NULL);
+    }
+    double secs = now() - start;
+    free(tid);
+    pthread_mutex_destroy(&job.lock);
+    pthread_cond_destroy(&job.order);
+
+    const char *why[5] = {"", "precision reached", "significant", "match limit", "out of memory"};
+    long long n = job.played;
+    double p = n ? (job.won[0] + 0.5 * job.won[2]) / n : 0, lo, hi;
+    wilson(p, n, 1.96, &lo, &hi);
+    printf("%s vs %s%s, %lld matches (%s)\n", job.a->name, job.b->name, job.team ? " 5v5" : "", n, why[job.stop]);
+    printf("%-12s %6.2f%%\n", job.a->name, n ? 100.0 * job.won[0] / n : 0);
+    printf("%-12s %6.2f%%\n", job.b->name, n ? 100.0 * job.won[1] / n : 0);
+    printf("%-12s %6.2f%%\n", "draw", n ? 100.0 * job.won[2] / n : 0);
+    printf("%s score %.2f%%, 95%% interval [%.2f%%, %.2f%%]\n", job.a->name, 100 * p, 100 * lo, 100 * hi);
+    printf("%.0f matches/s\n", secs > 0 ? n / secs : 0);
+    //Team matches keep their state on the stack, the arena only holds bot searches and recordings there
+    size_t peak = arenastat();
+    if (peak > 0) {
+        printf("Arena peak: %zu bytes in one batch\n", peak);
+    }
+
+    printf("|------------|----------|----------|--------|\n");
+    printf("|Weapon Name |Bought    |Won       |Win rate|\n");
+    printf("|------------|----------|----------|--------|\n");
+    for (int j = 0; j < game.cat->count; j++) {
+        if (job.tally.picked[j] > 0) {
+            printf("|%-12s|%10lld|%10lld|%7.2f%%|\n", wname(game.cat, j), job.tally.picked[j], job.tally.won[j],
+                   100.0 * job.tally.won[j] / job.tally.picked[j]);
+        }
+    }
+    printf("|------------|----------|----------|--------|\n");
+    if (job.record != NULL) {
+        long long bytes = out.offset;
+        printf("Recorded %lld matches to %s, %.1f bytes per match\n", out.matches, record,
+               out.matches ? (double)bytes / out.matches : 0);
+        replayclose(&out);
+    }
+
+    free(job.tally.picked);
+    free(job.tally.won);
+    return 0;
+}
+
+//LEB128: seven bits per byte, low bits first, the top bit set on all but the last
+size_t putvarint(unsigned char *p, unsigned long long v){
+
+    size_t n = 0;
+    while (v >= 128) {
+        p[n++] = (unsigned char)(v | 128);
+        v >>= 7;
+    }
+    p[n++] = (unsigned char)v;
+    return n;
+}
+
+unsigned long long getvarint(const unsigned char **p, const unsigned char *end){
+
+    unsigned long long v = 0;
+    for (int shift = 0; *p < end && shift < 64; shift += 7) {
+        unsigned char b = *(*p)++;
+        v |= (unsigned long long)(b & 127) << shift;
+        if (b < 128) {
+            break;
+        }
+    }
+    return v;
+}
+
+//Returns 0 at the end of the file
+int filevarint(FILE *f, unsigned long long *v){
+
+    *v = 0;
+    for (int shift = 0; shift < 64; shift += 7) {
+        int b = fgetc(f);
+        if (b == EOF) {
+            return 0;
+        }
+        *v |= (unsigned long long)(b & 127) << shift;
+        if (b < 128) {
+            return 1;
+        }
+    }
+    return 1;
+}
+
+//Most bytes a match of that many rounds can take, length prefix included
+size_t tapebound(int players, int rounds){
+
+    return 15 + (size_t)rounds * (2 * players * 20 + 10);
+}
+
+//The body starts after room for the longest length prefix, tapeend() closes the gap.
+//A tape without a buffer records nothing.
+void tapebegin(struct tapE *t, unsigned char *buf, int players, int side){
+
+    t->buf = buf;
+    if (buf == NULL) {
+        return;
+    }
+    t->used = 10;
+    t->players = players;
+    t->used += putvarint(buf + t->used, players);
+    t->used += putvarint(buf + t->used, side);
+    for (int k = 0; k < 2 * players; k++) {
+        t->last[k] = 0;
+    }
+}
+
+void taperound(struct tapE *t, const int *pick, const int *blnc, int win){
+
+    if (t->buf == NULL) {
+        return;
+    }
+    for (int k = 0; k < 2 * t->players; k++) {
+        long long d = (long long)blnc[k] - t->last[k];
+        t->used += putvarint(t->buf + t->used, (unsigned long long)(pick[k] + 1));
+        t->used += putvarint(t->buf + t->used, ((unsigned long long)d << 1) ^ (unsigned long long)(d >> 63));
+        t->last[k] = blnc[k];
+    }
+    t->used += putvarint(t->buf + t->used, win < 0 ? 2 : win);
+}
+
+//Moves the body behind its length, returns the bytes of the record
+size_t tapeend(struct tapE *t){
+
+    unsigned char len[10];
+    if (t->buf == NULL) {
+        return 0;
+    }
+    size_t body = t->used - 10, k = putvarint(len, body);
+    memmove(t->buf + k, t->buf + 10, body);
+    memcpy(t->buf, len, k);
+    return k + body;
+}
+
+//Starts a log, or with append continues one of the same game and bots. Returns -1 if
+//the file cannot be written or, when appending, holds another game's log.
+int replayopen(struct replaY *w, const char *file, int players, int batch, unsigned long long seed,
+               unsigned long long hash, const char *a, const char *b, int append){
+
+    memset(w, 0, sizeof(*w));
+    struct readeR r;
+    memset(&r, 0, sizeof(r));
+    if (append && replayread(&r, file) == 0) {
+        int same = r.players == players && r.hash == hash && strcmp(r.bot[0], a) == 0 && strcmp(r.bot[1], b) == 0;
+        //The new matches overwrite the old index, which is written again on close
+        long long end = r.stop;
+        replayfree(&r);
+        if (!same || r.matches < 0) {
+            free(r.index);
+            return -1;
+        }
+        w->file = fopen(file, "r+b");
+        if (w->file == NULL || ftruncate(fileno(w->file), end) != 0) {
+            free(r.index);
+            return -1;
+        }
+        fseek(w->file, end, SEEK_SET);
+        w->offset = end;
+        w->matches = r.matches;
+        w->index = r.index;
+        w->indexes = r.indexes;
+        w->ring = malloc(RING);
+        return 0;
+    }
+    if (append) {
+        FILE *f = fopen(file, "rb");
+        if (f != NULL) {
+            fclose(f);
+            return -1;
+        }
+    }
+
+    w->file = fopen(file, "wb");
+    if (w->file == NULL) {
+        return -1;
+    }
+    w->ring = malloc(RING);
+    unsigned char head[128];
+    size_t n = 0;
+    memcpy(head, "FSRP", 4);
+    n = 4;
+    head[n++] = 1;
+    head[n++] = (unsigned char)players;
+    n += putvarint(head + n, batch);
+    for (int k = 0; k < 8; k++) head[n++] = (unsigned char)(seed >> 8 * k);
+    for (int k = 0; k < 8; k++) head[n++] = (unsigned char)(hash >> 8 * k);
+    const char *bot[2] = {a, b};
+    for (int s = 0; s < 2; s++) {
+        size_t len = strlen(bot[s]) < 31 ? strlen(bot[s]) : 31;
+        head[n++] = (unsigned char)len;
+        memcpy(head + n, bot[s], len);
+        n += len;
+    }
+    replaybytes(w, head, n);
+    w->offset = n;
+    return 0;
+}
+
+//Appends through the ring, which is written out whenever the next bytes would not fit
+void replaybytes(struct replaY *w, const unsigned char *p, size_t n){
+
+    if (w->head - w->tail + n > RING) {
+        ringflush(w);
+    }
+    if (n > RING) {
+        fwrite(p, 1, n, w->file);
+        return;
+    }
+    size_t at = w->head % RING, first = RING - at < n ? RING - at : n;
+    memcpy(w->ring + at, p, first);
+    memcpy(w->ring, p + first, n - first);
+    w->head += n;
+}
+
+void ringflush(struct replaY *w){
+
+    size_t at = w->tail % RING, n = w->head - w->tail;
+    size_t first = RING - at < n ? RING - at : n;
+    fwrite(w->ring + at, 1, first, w->file);
+    fwrite(w->ring, 1, n - first, w->file);
+    w->tail = w->head;
+}
+
+//One finished tape, every INDEXSTEP-th match also gets an index entry
+void replaymatch(struct replaY *w, const unsigned char *p, size_t n){
+
+    if (w->matches % INDEXSTEP == 0) {
+        w->index = realloc(w->index, (w->indexes + 1) * sizeof(long long));
+        w->index[w->indexes++] = w->offset;
+    }
+    replaybytes(w, p, n);
+    w->offset += n;
+    w->matches++;
+}
+
+void replayclose(struct replaY *w){
+
+    unsigned char buf[32];
+    long long at = w->offset, last = 0;
+    replaybytes(w, buf, putvarint(buf, w->indexes));
+    for (int k = 0; k < w->indexes; k++) {
+        replaybytes(w, buf, putvarint(buf, w->index[k] - last));
+        last = w->index[k];
+    }
+    for (int k = 0; k < 8; k++) buf[k] = (unsigned char)(w->matches >> 8 * k);
+    for (int k = 0; k < 8; k++) buf[8 + k] = (unsigned char)(at >> 8 * k);
+    memcpy(buf + 16, "FSRX", 4);
+    replaybytes(w, buf, 20);
+    ringflush(w);
+    fclose(w->file);
+    free(w->ring);
+    free(w->index);
+    memset(w, 0, sizeof(*w));
+}
+
+//Appends a finished game to play.bin, a log of every game played against the same bot
+void logplay(struct tapE *t, int players, unsigned long long seed){
+
+    struct replaY w;
+    size_t n = tapeend(t);
+    if (t->buf == NULL) {
+        printf("There was no memory to record this game\n");
+        return;
+    }
+    if (replayopen(&w, "play.bin", players, 0, seed, cataloghash(&game), "human", enemybot->name, 1) < 0) {
+        printf("play.bin holds games of another setup or bot, this one was not recorded\n");
+        return;
+    }
+    replaymatch(&w, t->buf, n);
+    replayclose(&w);
+}
+
+//Opens a log and loads its index. A log without its trailer, e.g. cut short, can
+//still be read from the start: matches is then -1.
+int replayread(struct readeR *r, const char *file){
+
+    unsigned char head[22];
+    r->file = fopen(file, "rb");
+    if (r->file == NULL) {
+        return -1;
+    }
+    if (fread(head, 1, 6, r->file) != 6 || memcmp(head, "FSRP", 4) != 0 || head[4] != 1) {
+        replayfree(r);
+        return -1;
+    }
+    unsigned long long v;
+    r->players = head[5];
+    filevarint(r->file, &v);
+    r->batch = (int)v;
+    if (fread(head, 1, 16, r->file) != 16) {
+        replayfree(r);
+        return -1;
+    }
+    r->seed = r->hash = 0;
+    for (int k = 7; k >= 0; k--) {
+        r->seed = r->seed << 8 | head[k];
+        r->hash = r->hash << 8 | head[8 + k];
+    }
+    for (int s = 0; s < 2; s++) {
+        int len = fgetc(r->file);
+        if (len == EOF || len > 31 || fread(r->bot[s], 1, len, r->file) != (size_t)len) {
+            replayfree(r);
+            return -1;
+        }
+        r->bot[s][len] = 0;
+    }
+    r->data = ftell(r->file);
+
+    unsigned char tail[20];
+    long long count = 0, at = 0, end = -1;
+    r->matches = -1;
+    r->indexes = 0;
+    r->index = NULL;
+    if (fseek(r->file, -20, SEEK_END) == 0 && (end = ftell(r->file)) >= 0 && fread(tail, 1, 20, r->file) == 20
+            && memcmp(tail + 16, "FSRX", 4) == 0) {
+        for (int k = 7; k >= 0; k--) {
+            count = count << 8 | tail[k];
+            at = at << 8 | tail[8 + k];
+        }
+        //The index must hold one entry per INDEXSTEP matches, each inside the match
+        //records and after the one before, and end right where the trailer starts
+        int ok = count >= 0 && at >= r->data && at < end && fseek(r->file, at, SEEK_SET) == 0 && filevarint(r->file, &v);
+        ok = ok && v == (unsigned long long)((count + INDEXSTEP - 1) / INDEXSTEP);
+        if (ok) {
+            r->matches = count;
+            r->stop = at;
+            r->indexes = (int)v;
+            r->index = malloc((r->indexes + 1) * sizeof(long long));
+            long long last = 0;
+            for (int k = 0; ok && k < r->indexes; k++) {
+                ok = filevarint(r->file, &v) && v <= (unsigned long long)at;
+                last += ok ? (long long)v : 0;
+                ok = ok && last >= r->data && last < at && (k == 0 || last > r->index[k - 1]);
+                r->index[k] = last;
+            }
+            ok = ok && ftell(r->file) == end;
+        }
+        if (!ok) {
+            free(r->index);
+            r->index = NULL;
+            replayfree(r);
+            return -1;
+        }
+    }
+    fseek(r->file, r->data, SEEK_SET);
+    r->next = 0;
+    return 0;
+}
+
+//Positions the reader on match n: a jump to the index entry at or before it, then a
+//skip over at most INDEXSTEP - 1 records by their lengths
+int replayseek(struct readeR *r, long long n){
+
+    if (n < 0 || (r->matches >= 0 && n >= r->matches)) {
+        return -1;
+    }
+    long long k = r->indexes > 0 ? n / INDEXSTEP : 0;
+    if (k >= r->indexes) {
+        k = r->indexes > 0 ? r->indexes - 1 : 0;
+    }
+    fseek(r->file, r->indexes > 0 ? r->index[k] : r->data, SEEK_SET);
+    r->next = r->indexes > 0 ? k * INDEXSTEP : 0;
+    unsigned long long len;
+    while (r->next < n) {
+        if (!filevarint(r->file, &len) || fseek(r->file, (long)len, SEEK_CUR) != 0) {
+            return -1;
+        }
+        r->next++;
+    }
+    return 0;
+}
+
+//Decodes the next match, returns 0 past the last one
+int replaynext(struct readeR *r, struct recorD *m){
+
+    unsigned long long len;
+    if ((r->matches >= 0 && r->next >= r->matches) || !filevarint(r->file, &len)) {
+        return 0;
+    }
+    if (len > r->cap) {
+        r->cap = len;
+        r->body = realloc(r->body, r->cap);
+    }
+    if (fread(r->body, 1, len, r->file) != len) {
+        return 0;
+    }
+    r->next++;
+    const unsigned char *p = r->body, *end = r->body + len;
+    m->players = (int)getvarint(&p, end);
+    m->side = (int)getvarint(&p, end);
+    m->rounds = 0;
+    if (m->players < 1 || m->players > TEAM) {
+        return 0;
+    }
+    int last[2 * TEAM] = {0}, width = 2 * m->players;
+    while (p < end) {
+        if (m->rounds == m->cap) {
+            m->cap = m->cap ? 2 * m->cap : 16;
+            m->pick = realloc(m->pick, (size_t)m->cap * width * sizeof(int));
+            m->blnc = realloc(m->blnc, (size_t)m->cap * width * sizeof(int));
+            m->win = realloc(m->win, m->cap * sizeof(int));
+        }
+        for (int k = 0; k < width; k++) {
+            unsigned long long z;
+            m->pick[m->rounds * width + k] = (int)getvarint(&p, end) - 1;
+            z = getvarint(&p, end);
+            last[k] += (int)((long long)(z >> 1) ^ -(long long)(z & 1));
+            m->blnc[m->rounds * width + k] = last[k];
+        }
+        m->win[m->rounds++] = (int)getvarint(&p, end);
+    }
+    return 1;
+}
+
+void replayfree(struct readeR *r){
+
+    if (r->file != NULL) {
+        fclose(r->file);
+    }
+    free(r->body);
+    r->file = NULL;
+    r->body = NULL;
+    r->cap = 0;
+}
+
+//ammo replay <file> [match]: a log's header and one of its matches round by round
+int replay(int argc, char *argv[]){
+
+    static struct readeR r;
+    static struct recorD m;
+
+    if (argc < 3) {
+        printf("Usage: %s replay <file> [match]\n", argv[0]);
+        return 1;
+    }
+    if (replayread(&r, argv[2]) < 0) {
+        printf("%s is not a replay log\n", argv[2]);
+        return 1;
+    }
+    long long n = argc > 3 ? atoll(argv[3]) : 0;
+    fseek(r.file, 0, SEEK_END);
+    long bytes = ftell(r.file);
+    if (r.matches < 0) {
+        printf("%s has no index, it was cut short\n", argv[2]);
+    }
+    printf("%s: %lld matches of %s vs %s, %dv%d, seed %llu, %ld bytes\n", argv[2], r.matches < 0 ? 0 : r.matches,
+           r.bot[0], r.bot[1], r.players, r.players, r.seed, bytes);
+    if (r.hash != cataloghash(&game)) {
+        printf("Recorded with another catalog, schedule or economy\n");
+    }
+    if (replayseek(&r, n) < 0 || !replaynext(&r, &m)) {
+        printf("No match %lld\n", n);
+        replayfree(&r);
+        free(r.index);
+        return 1;
+    }
+
+    //Simulated series alternate seats as seatmatch() does, played games do not
+    const char *seat[2] = {r.bot[r.batch > 0 && (n & 1)], r.bot[!(r.batch > 0 && (n & 1))]};
+    printf("Match %lld: %s plays %s, %s plays %s\n", n, seat[0], sidename[m.side], seat[1], sidename[!m.side]);
+    int score[2] = {0, 0}, width = 2 * m.players;
+    for (int k = 0; k < m.rounds; k++) {
+        printf("Round %d:", k + 1);
+        for (int p = 0; p < width; p++) {
+            int j = m.pick[k * width + p];
+            printf("%s $%d %s", p == m.players ? " |" : "", m.blnc[k * width + p],
+                   j < game.cat->count ? wname(game.cat, j) : "?");
+        }
+        if (m.win[k] < 2) {
+            score[m.win[k]]++;
+            printf(" -> %s\n", seat[m.win[k]]);
+        } else {
+            printf(" -> no buy round\n");
+        }
+    }
+    printf("Score %s %d, %s %d\n", seat[0], score[0], seat[1], score[1]);
+    replayfree(&r);
+    free(r.index);
+    return 0;
+}
+
+//Plays a logged match again on its recorded buys under g's rules, a 5v5 one with its
+//recorded wave stream. Balances follow the new rules, so a buy the replayed balance
+//cannot pay counts in broke but is still made. Rounds past the recorded ones are not
+//played. Returns the rounds played, -1 if a buy is not a row of g's catalog.
+int rematch(const struct gamE *g, const struct recorD *m, struct rnG *wave, int now[2], int *flips, int *broke){
+
+    int width = 2 * m->players, k = 0;
+    for (int i = 0; i < m->rounds * width; i++) {
+        if (m->pick[i] >= g->cat->count) {
+            return -1;
+        }
+    }
+    *flips = *broke = 0;
+    if (m->players == 1) {
+        struct matcH s;
+        newmatch(g, &s);
+        for (; k < m->rounds && s.round < g->rounds; k++) {
+            const int *pick = m->pick + k * width;
+            for (int p = 0; p < 2; p++) {
+                *broke |= pick[p] >= 0 && g->cat->price[pick[p]] > s.blnc[p];
+            }
+            int win = resolve(g, &s, pick[0], pick[1]);
+            *flips += (win < 0 ? 2 : win) != m->win[k];
+        }
+        now[0] = s.score[0];
+        now[1] = s.score[1];
+        return k;
+    }
+
+    struct teaM t;
+    int buy[2][TEAM];
+    newteam(g, &t);
+    for (; k < m->rounds && t.round < g->rounds; k++) {
+        memcpy(buy, m->pick + k * width, sizeof(buy));
+        for (int p = 0; p < width; p++) {
+            *broke |= buy[p / TEAM][p % TEAM] >= 0 && g->cat->price[buy[p / TEAM][p % TEAM]] > t.blnc[p / TEAM][p % TEAM];
+        }
+        int win = teamround(g, &t, buy, wave, NULL);
+        *flips += (win < 0 ? 2 : win) != m->win[k];
+    }
+    now[0] = t.score[0];
+    now[1] = t.score[1];
+    return k;
+}
+
+//Takes free segments and plays their matches again, each worker reads the log
+//through its own file
+void *verifyworker(void *arg){
+
+    struct verifY *job = arg;
+    const struct gamE *g = job->g;
+    struct readeR r = *job->log;
+    struct recorD m;
+    memset(&m, 0, sizeof(m));
+    r.file = fopen(job->file, "rb");
+    r.body = NULL;
+    r.cap = 0;
+    if (r.file == NULL) {
+        return NULL;
+    }
+    //Sim logs replay 5v5 waves from the batch stream, drawn as simworker() and
+    //teammatch() draw them: three per match, the waves take the third
+    struct rnG batch = {0, 0}, wave = {0, 0};
+    long long id = -1, at = 0;
+
+    pthread_mutex_lock(&job->lock);
+    while (job->next < job->segments) {
+        long long k = job->next++;
+        pthread_mutex_unlock(&job->lock);
+
+        long long first = k * INDEXSTEP, last = r.matches < 0 ? -1 : first + INDEXSTEP < r.matches ? first + INDEXSTEP : r.matches;
+        long long checked = 0, changed = 0, rounds = 0, flipped = 0, dropped = 0, broke = 0, skipped = 0;
+        long long match[SHOWN];
+        int shown = 0, was[SHOWN][2], now[SHOWN][2];
+        if (replayseek(&r, first) < 0) {
+            last = first;
+        }
+        for (long long n = first; (last < 0 || n < last) && replaynext(&r, &m); n++) {
+            if (m.players == TEAM) {
+                if (r.batch <= 0) {
+                    skipped++;
+                    continue;
+                }
+                long long i = n % r.batch;
+                if (n / r.batch != id || i < at) {
+                    id = n / r.batch;
+                    batch.s = r.seed + (unsigned long long)id * 0xd1b54a32d192ed03ULL;
+                    batch.flip = 0;
+                    at = 0;
+                }
+                for (; at <= i; at++) {
+                    rnd(&batch);
+                    rnd(&batch);
+                    wave.s = rnd(&batch);
+                }
+            }
+            int score[2], flips, bust, told[2] = {0, 0};
+            int played = rematch(g, &m, &wave, score, &flips, &bust);
+            if (played < 0) {
+                skipped++;
+                continue;
+            }
+            for (int j = 0; j < m.rounds; j++) {
+                told[0] += m.win[j] == 0;
+                told[1] += m.win[j] == 1;
+            }
+            int before = told[0] > told[1] ? 0 : told[1] > told[0] ? 1 : 2;
+            int after = score[0] > score[1] ? 0 : score[1] > score[0] ? 1 : 2;
+            checked++;
+            rounds += m.rounds;
+            flipped += flips;
+            dropped += m.rounds - played;
+            broke += bust;
+            if (before != after) {
+                changed++;
+                if (shown < SHOWN) {
+                    match[shown] = n;
+                    memcpy(was[shown], told, sizeof(told));
+                    memcpy(now[shown], score, sizeof(score));
+                    shown++;
+                }
+            }
+        }
+
+        pthread_mutex_lock(&job->lock);
+        job->checked += checked;
+        job->changed += changed;
+        job->rounds += rounds;
+        job->flipped += flipped;
+        job->dropped += dropped;
+        job->broke += broke;
+        job->skipped += skipped;
+        //The first divergences of the log, whatever order the segments finish in
+        for (int j = 0; j < shown; j++) {
+            int p = job->shown < SHOWN ? job->shown++ : SHOWN;
+            while (p > 0 && job->match[p - 1] > match[j]) {
+                if (p < SHOWN) {
+                    job->match[p] = job->match[p - 1];
+                    memcpy(job->was[p], job->was[p - 1], sizeof(job->was[p]));
+                    memcpy(job->now[p], job->now[p - 1], sizeof(job->now[p]));
+                }
+                p--;
+            }
+            if (p < SHOWN) {
+                job->match[p] = match[j];
+                memcpy(job->was[p], was[j], sizeof(was[j]));
+                memcpy(job->now[p], now[j], sizeof(now[j]));
+            }
+        }
+    }
+    pthread_mutex_unlock(&job->lock);
+
+    replayfree(&r);
+    free(m.pick);
+    free(m.blnc);
+    free(m.win);
+    return NULL;
+}
+
+//ammo verify <file> [catalog] [formula]: plays every logged match again on its
+//recorded buys, under the loaded game or the given catalog scored with the given
+//formula (default classic, as the loaded game), and reports the matches whose
+//result changes
+int verify(int argc, char *argv[]){
+
+    static struct verifY job;
+    static struct readeR r;
+    static struct casE other;
+    static struct gamE variant;
+
+    if (argc < 3) {
+        printf("Usage: %s verify <file> [catalog] [formula]\n", argv[0]);
+        return 1;
+    }
+    if (replayread(&r, argv[2]) < 0) {
+        printf("%s is not a replay log\n", argv[2]);
+        return 1;
+    }
+    job.g = &game;
+    if (argc > 3) {
+        int formula = argc > 4 ? -1 : 0;
+        for (int f = 0; argc > 4 && f < FORMULAS; f++) {
+            if (strcmp(argv[4], formulas[f]) == 0) {
+                formula = f;
+            }
+        }
+        if (formula < 0) {
+            printf("Unknown formula %s\n", argv[4]);
+            replayfree(&r);
+            return 1;
+        }
+        int n = loadcase(&other, argv[3]);
+        if (n < 0) {
+            printf("%s could not be opened\n", argv[3]);
+            replayfree(&r);
+            return 1;
+        }
+        variant.cat = &other;
+        variant.eco = game.eco;
+        variant.score = malloc((n + 1) * sizeof(double));
+        score(&other, formula, variant.score);
+        buildgame(&variant);
+        job.g = &variant;
+    }
+    job.file = argv[2];
+    job.log = &r;
+    job.segments = r.indexes > 0 ? r.indexes : 1;
+    pthread_mutex_init(&job.lock, NULL);
+
+    int threads = cores() < job.segments ? cores() : job.segments;
+    pthread_t *tid = malloc(threads * sizeof(pthread_t));
+    double start = now();
+    for (int k = 1; k < threads; k++) {
+        pthread_create(&tid[k], NULL, verifyworker, &job);
+    }
+    verifyworker(&job);
+    for (int k = 1; k < threads; k++) {
+        pthread_join(tid[k], NULL);
+    }
+    double secs = now() - start;
+    free(tid);
+    pthread_mutex_destroy(&job.lock);
+
+    printf("%s: %s vs %s, %dv%d, against %s\n", argv[2], r.bot[0], r.bot[1], r.players, r.players,
+           argc > 3 ? argv[3] : "the loaded game");
+    printf("Checked %lld matches in %d segments on %d threads\n", job.checked, job.segments, threads);
+    printf("Results changed: %lld matches (%.3f%%)\n", job.changed,
+           job.checked ? 100.0 * job.changed / job.checked : 0);
+    //Both counts are out of the logged rounds, a round no longer played is not also changed
+    printf("Rounds changed: %lld of %lld\n", job.flipped, job.rounds);
+    if (job.dropped > 0) {
+        printf("Rounds no longer played, the match ends earlier: %lld of %lld\n", job.dropped, job.rounds);
+    }
+    printf("Recorded buys the replayed balance cannot pay: %lld matches\n", job.broke);
+    if (job.skipped > 0) {
+        printf("Skipped %lld matches: buys outside the catalog or 5v5 games played interactively\n", job.skipped);
+    }
+    //Seats alternate in simulated series as in replay()
+    for (int k = 0; k < job.shown; k++) {
+        long long n = job.match[k];
+        const char *seat[2] = {r.bot[r.batch > 0 && (n & 1)], r.bot[!(r.batch > 0 && (n & 1))]};
+        printf("Match %lld: %s %d %s %d, now %d %d\n", n, seat[0], job.was[k][0], seat[1], job.was[k][1],
+               job.now[k][0], job.now[k][1]);
+    }
+    if (job.changed == 0 && job.flipped == 0 && job.dropped == 0 && job.g == &game && r.hash == cataloghash(&game)) {
+        printf("Every match replays as recorded\n");
+    }
+    printf("%.0f matches/s\n", secs > 0 ? job.checked / secs : 0);
+
+    replayfree(&r);
+    free(r.index);
+    free(variant.score);
+    return 0;
+}
+
+void *abworker(void *arg){
+
+    pooled = 1;
+    struct pairjoB *job = arg;
+
+    pthread_mutex_lock(&job->lock);
+    while (job->next * job->batch < job->pairs) {
+        long long id = job->next++;
+        pthread_mutex_unlock(&job->lock);
+
+        long long first = id * job->batch;
+        long long last = first + job->batch < job->pairs ? first + job->batch : job->pairs;
+        double sum[2] = {0, 0}, sq[2] = {0, 0}, dsum = 0, dsq = 0;
+        for (long long i = first; i < last; i++) {
+            double x[2] = {0, 0};
+            //One draw of the pair is the seed's stream, the antithetic one its mirror
+            for (int twin = 0; twin <= job->antithetic; twin++) {
+                for (int v = 0; v < 2; v++) {
+                    struct rnG rng = {job->seed + (unsigned long long)i * 0xd1b54a32d192ed03ULL, twin ? ~0ULL : 0};
+                    int w = seatmatch(job->g[v], job->a, job->b, i, &rng, NULL);
+                    x[v] += (w == 0 ? 1 : w == 2 ? 0.5 : 0) / (job->antithetic + 1);
+                }
+            }
+            for (int v = 0; v < 2; v++) {
+                sum[v] += x[v];
+                sq[v] += x[v] * x[v];
+            }
+            dsum += x[1] - x[0];
+            dsq += (x[1] - x[0]) * (x[1] - x[0]);
+        }
+
+        pthread_mutex_lock(&job->lock);
+        for (int v = 0; v < 2; v++) {
+            job->sum[v] += sum[v];
+            job->sq[v] += sq[v];
+        }
+        job->dsum += dsum;
+        job->dsq += dsq;
+    }
+    pthread_mutex_unlock(&job->lock);
+    pooled = 0;
+    return NULL;
+}
+
+//ammo ab <bot> <bot> <catalog> <formula> [pairs] [seed]: variant A is the loaded game,
+//variant B the given catalog scored with the given formula. Both variants play
+//every match on the same streams, so only the paired difference is noisy.
+int abtest(int argc, char *argv[]){
+
+    static struct pairjoB job;
+    static struct casE other;
+    double v;
+
+    job.antithetic = flag(&argc, argv, "--antithetic", &v) ? v != 0 : 0;
+    job.batch = flag(&argc, argv, "--batch", &v) ? (int)v : 4096;
+    job.pairs = argc > 6 ? atoll(argv[6]) : 1000000;
+    if (argc < 6 || job.pairs <= 0) {
+        printf("Usage: %s ab <bot> <bot> <catalog> <formula> [pairs] [seed] [--antithetic 1]\n", argv[0]);
+        return 1;
+    }
+    job.a = findbot(argv[2]);
+    job.b = findbot(argv[3]);
+    if (job.a == NULL || job.b == NULL) {
+        printf("Unknown bot %s\n", job.a == NULL ? argv[2] : argv[3]);
+        return 1;
+    }
+    int formula = -1;
+    for (int f = 0; f < FORMULAS; f++) {
+        if (strcmp(argv[5], formulas[f]) == 0) {
+            formula = f;
+        }
+    }
+    if (formula < 0) {
+        printf("Unknown formula %s\n", argv[5]);
+        return 1;
+    }
+    int n = loadcase(&other, argv[4]);
+    if (n < 0) {
+        printf("%s could not be opened\n", argv[4]);
+        return 1;
+    }
+    static struct gamE variant;
+    variant.cat = &other;
+    variant.eco = game.eco;
+    variant.score = malloc((n + 1) * sizeof(double));
+    score(&other, formula, variant.score);
+    buildgame(&variant);
+
+    job.g[0] = &game;
+    job.g[1] = &variant;
+    job.seed = argc > 7 ? strtoull(argv[7], NULL, 10) : (unsigned long long)time(NULL);
+    pthread_mutex_init(&job.lock, NULL);
+
+    int threads = cores();
+    pthread_t *tid = malloc(threads * sizeof(pthread_t));
+    double start = now();
+    for (int k = 1; k < threads; k++) {
+        pthread_create(&tid[k], NULL, abworker, &job);
+    }
+    abworker(&job);
+    for (int k = 1; k < threads; k++) {
+        pthread_join(tid[k], NULL);
+    }
+    double secs = now() - start;
+    free(tid);
+    pthread_mutex_destroy(&job.lock);
+
+    double m = job.pairs;
+    double mean[2], var[2];
+    for (int k = 0; k < 2; k++) {
+        mean[k] = job.sum[k] / m;
+        var[k] = m > 1 ? (job.sq[k] - m * mean[k] * mean[k]) / (m - 1) : 0;
+    }
+    double diff = job.dsum / m;
+    double dvar = m > 1 ? (job.dsq - m * diff * diff) / (m - 1) : 0;
+    double half = 1.96 * sqrt(dvar / m);
+
+    printf("%s vs %s, %lld pairs%s\n", job.a->name, job.b->name, job.pairs, job.antithetic ? " of antithetic twins" : "");
+    printf("A: %-10s %6.2f%%\n", "case.txt", 100 * mean[0]);
+    printf("B: %-10s %6.2f%% (%s)\n", argv[4], 100 * mean[1], formulas[formula]);
+    printf("B - A: %+.3f%%, 95%% interval [%+.3f%%, %+.3f%%]\n", 100 * diff, 100 * (diff - half), 100 * (diff + half));
+    //Independent runs of the same size would have the variance of the sum
+    if (dvar > 0) {
+        printf("Variance reduction vs independent runs: %.1fx\n", (var[0] + var[1]) / dvar);
+    }
+    printf("%.0f pairs/s\n", secs > 0 ? m / secs : 0);
+
+    free(variant.score);
+    return 0;
+}
+
+void buildtune(struct tunE *tn, const struct gamE *g, const int *base, int samples){
+
+    int n = g->cat->count;
+    tn->g = g;
+    tn->base = base;
+    tn->samples = samples;
+    tn->seed = 0x5eedULL;
+    for (int s = 0; s < 2; s++) {
+        tn->slot[s] = malloc(((size_t)g->pools * (n + 1) + 1) * sizeof(int));
+        for (int p = 0; p < g->pools; p++) {
+            int *slot = tn->slot[s] + (size_t)p * (n + 1);
+            for (int j = 0; j <= n; j++) {
+                slot[j] = -1;
+            }
+            for (int k = 0; k < g->sides[s][p].count; k++) {
+                slot[g->sides[s][p].idx[k]] = k;
+            }
+        }
+    }
+    tn->price = malloc((n + 1) * sizeof(int));
+    tn->won = malloc((size_t)n * samples + 1);
+    tn->trail = malloc(((size_t)n * samples * g->rounds * 4 + 1) * sizeof(int));
+    memcpy(tn->price, base, n * sizeof(int));
+    for (int j = 0; j < n; j++) {
+        for (int s = 0; s < samples; s++) {
+            size_t c = (size_t)j * samples + s;
+            tn->won[c] = commitmatch(tn, base, j, s, tn->trail + c * g->rounds * 4);
+        }
+    }
+}
+
+//One committed match, see committed(): sample s of the player who commits to row j.
+//Returns 1 if that player wins. With a trail, every round's balances before buying
+//and both buys are written to it.
+int commitmatch(const struct tunE *tn, const int *price, int j, int s, int *trail){
+
+    const struct gamE *g = tn->g;
+    const struct ecoN *e = g->eco;
+    int n = g->cat->count, mask = g->cat->side[j];
+    struct rnG rng = {tn->seed + (unsigned long long)s * 0xd1b54a32d192ed03ULL, 0};
+    int side = mask == 2 || (mask == 3 && (s & 1));
+    int blnc[2], score[2] = {0, 0}, streak[2] = {0, 0};
+
+    if (trail != NULL) {
+        for (int k = 0; k < g->rounds * 4; k++) {
+            trail[k] = -1;
+        }
+    }
+    blnc[0] = blnc[1] = e->start + roundincome(g, 0);
+    for (int r = 0; r < g->rounds; r++) {
+        int p = g->draw[r];
+        const struct tieR *mine = &g->sides[side][p], *theirs = &g->sides[!side][p];
+        if (roundtier(g, r)->count > 0) {
+            int a = -1, b = -1, affordable = 0;
+            if (tn->slot[side][(size_t)p * (n + 1) + j] >= 0) {
+                a = price[j] <= blnc[0] ? j : -1;
+            } else {
+                for (int k = 0; k < mine->count; k++) {
+                    int x = mine->idx[k];
+                    if (price[x] <= blnc[0] && (a < 0 || g->score[x] > g->score[a])) {
+                        a = x;
+                    }
+                }
+            }
+            for (int k = 0; k < theirs->count; k++) {
+                affordable += price[theirs->idx[k]] <= blnc[1];
+            }
+            if (affordable > 0) {
+                int pick = rndint(&rng, affordable), k;
+                for (k = 0; price[theirs->idx[k]] > blnc[1] || pick-- > 0; k++);
+                b = theirs->idx[k];
+            }
+            if (trail != NULL) {
+                int *t = trail + r * 4;
+                t[0] = blnc[0];
+                t[1] = blnc[1];
+                t[2] = a;
+                t[3] = b;
+            }
+            //As in resolve(): the higher score wins, a tie goes to the opponent
+            int win;
+            if (a < 0 || b < 0) {
+                double sa = a < 0 ? 0 : g->score[a], sb = b < 0 ? 0 : g->score[b];
+                win = !(sa > sb);
+            } else {
+                const struct tieR *ct = &g->sides[1][p];
+                int ka = tn->slot[side][(size_t)p * (n + 1) + a], kb = tn->slot[!side][(size_t)p * (n + 1) + b];
+                int v = side == 0 ? g->matchup[p][(size_t)ka * ct->count + kb] : -g->matchup[p][(size_t)kb * ct->count + ka];
+                win = !(v > 0);
+            }
+            int row[2] = {a, b};
+            score[win]++;
+            for (int q = 0; q < 2; q++) {
+                blnc[q] -= row[q] < 0 ? 0 : price[row[q]];
+                if (q == win) {
+                    blnc[q] += e->win + g->kill[row[q] < 0 ? n : row[q]];
+                    streak[q] = 0;
+                } else {
+                    blnc[q] += e->loss[streak[q] < STREAKS ? streak[q] : STREAKS - 1];
+                    streak[q]++;
+                }
+            }
+            if (g->firstto > 0 && score[win] >= g->firstto) {
+                break;
+            }
+        }
+        for (int q = 0; r + 1 < g->rounds && q < 2; q++) {
+            blnc[q] = blnc[q] * e->carry / 100 + roundincome(g, r + 1);
+            if (e->cap > 0 && blnc[q] > e->cap) {
+                blnc[q] = e->cap;
+            }
+        }
+    }
+    return score[0] > score[1];
+}
+
+//Whether moving row m to another price in [lo, hi] can change the cached match of
+//row j and sample s: only if m was bought, or a balance it was compared with lies
+//in [lo, hi). Otherwise every buy and so the result stay the same.
+int touched(const struct tunE *tn, int j, int s, int m, int lo, int hi){
+
+    const struct gamE *g = tn->g;
+    int n = g->cat->count, mask = g->cat->side[j];
+    int side = mask == 2 || (mask == 3 && (s & 1));
+    const int *trail = tn->trail + ((size_t)j * tn->samples + s) * g->rounds * 4;
+
+    for (int r = 0; r < g->rounds; r++) {
+        const int *t = trail + r * 4;
+        size_t at = (size_t)g->draw[r] * (n + 1);
+        if (t[2] == m || t[3] == m) {
+            return 1;
+        }
+        //A greedy buyer only switches to m if it beats the row bought, a committed one never looks at m
+        if (tn->slot[side][at + m] >= 0 && tn->slot[side][at + j] < 0 && t[0] >= lo && t[0] < hi
+                && (t[2] < 0 || g->score[m] >= g->score[t[2]])) {
+            return 1;
+        }
+        if (tn->slot[!side][at + m] >= 0 && t[1] >= lo && t[1] < hi) {
+            return 1;
+        }
+    }
+    return 0;
+}
+
+//The one row where price differs from the cached list, with its old and new price in
+//lo and hi sorted; -1 if none differs and -2 if more than one does
+int moverow(const struct tunE *tn, const int *price, int *lo, int *hi){
+
+    int moved = -1;
+    for (int m = 0; m < tn->g->cat->count; m++) {
+        if (price[m] != tn->price[m]) {
+            moved = moved == -1 ? m : -2;
+        }
+    }
+    *lo = *hi = 0;
+    if (moved >= 0) {
+        *lo = price[moved] < tn->price[moved] ? price[moved] : tn->price[moved];
+        *hi = price[moved] + tn->price[moved] - *lo;
+    }
+    return moved;
+}
+
+//Makes price the cached list, replaying only the matches its move could change
+void retune(struct tunE *tn, const int *price){
+
+    const struct gamE *g = tn->g;
+    int n = g->cat->count, lo, hi, moved = moverow(tn, price, &lo, &hi);
+    for (int j = 0; j < n; j++) {
+        for (int s = 0; s < tn->samples; s++) {
+            size_t c = (size_t)j * tn->samples + s;
+            if (moved == -2 || j == moved || (moved >= 0 && touched(tn, j, s, moved, lo, hi))) {
+                tn->won[c] = commitmatch(tn, price, j, s, tn->trail + c * g->rounds * 4);
+            }
+        }
+    }
+    memcpy(tn->price, price, n * sizeof(int));
+}
+
+//For every row, the match win rate of a player who commits to it in every round whose
+//pool holds it (buying nothing if it cannot pay) and buys greedily in the others, against a uniform
+//affordable opponent. Both play from their side's pool of the round and are paid as
+//resolve() pays them, only at the candidate prices. A row both sides may buy is
+//played as T in even samples and as CT in odd ones. A fair price list makes every
+//commitment in a tier equally good, so the cost is the spread of those rates inside
+//each tier plus a small pull towards the current prices. A candidate one row away
+//from the cached prices reuses every cached match that row cannot touch.
+double committed(const struct tunE *tn, const int *price, double *rate){
+
+    const struct gamE *g = tn->g;
+    int lo, hi, moved = moverow(tn, price, &lo, &hi);
+    double cost = 0;
+
+    for (int r0 = 0; r0 < TIERS; r0++) {
+        const struct tieR *t0 = &g->tier[r0];
+        double mean = 0;
+        for (int i0 = 0; i0 < t0->count; i0++) {
+            int j = t0->idx[i0], wins = 0;
+            for (int s = 0; s < tn->samples; s++) {
+                if (moved == -2 || j == moved || (moved >= 0 && touched(tn, j, s, moved, lo, hi))) {
+                    wins += commitmatch(tn, price, j, s, NULL);
+                } else {
+                    wins += tn->won[(size_t)j * tn->samples + s];
+                }
+            }
+            rate[j] = (double)wins / tn->samples;
+            mean += rate[j];
+        }
+        mean /= t0->count > 0 ? t0->count : 1;
+        for (int i0 = 0; i0 < t0->count; i0++) {
+            int j = t0->idx[i0];
+            double d = (price[j] - tn->base[j]) / (double)(tn->base[j] > 0 ? tn->base[j] : 1);
+            cost += (rate[j] - mean) * (rate[j] - mean) + 0.001 * d * d;
+        }
+    }
+    return cost;
+}
+
+void freetune(struct tunE *tn){
+
+    free(tn->slot[0]);
+    free(tn->slot[1]);
+    free(tn->price);
+    free(tn->won);
+    free(tn->trail);
+}
+
+void *candworker(void *arg){
+
+    struct candjoB *job = arg;
+    double *rate = malloc((job->tn->g->cat->count + 1) * sizeof(double));
+
+    pthread_mutex_lock(&job->lock);
+    while (job->next < job->n) {
+        int c = job->next++;
+        pthread_mutex_unlock(&job->lock);
+        job->cost[c] = committed(job->tn, job->price[c], rate);
+        pthread_mutex_lock(&job->lock);
+    }
+    pthread_mutex_unlock(&job->lock);
+
+    free(rate);
+    return NULL;
+}
+
+void scorebatch(const struct tunE *tn, int n, int **price, double *cost){
+
+    struct candjoB job;
+    job.tn = tn;
+    job.n = n;
+    job.price = price;
+    job.cost = cost;
+    job.next = 0;
+    pthread_mutex_init(&job.lock, NULL);
+
+    int threads = cores() < n ? cores() : n;
+    pthread_t *tid = malloc((threads + 1) * sizeof(pthread_t));
+    for (int k = 1; k < threads; k++) {
+        pthread_create(&tid[k], NULL, candworker, &job);
+    }
+    candworker(&job);
+    for (int k = 1; k < threads; k++) {
+        pthread_join(tid[k], NULL);
+    }
+    free(tid);
+    pthread_mutex_destroy(&job.lock);
+}
+
+//ammo rebalance [out]: parallel coordinate search over prices in $50 steps. Every
+//iteration scores a price move up and down for each row at once and keeps the best;
+//when nothing improves the step is halved.
+int rebalance(int argc, char *argv[]){
+
+    double v;
+    int samples = flag(&argc, argv, "--samples", &v) ? (int)v : 64;
+    int iterations = flag(&argc, argv, "--iterations", &v) ? (int)v : 200;
+    const char *file = argc > 2 ? argv[2] : "case.proposed.txt";
+    int n = game.cat->count;
+
+    struct tunE tn;
+    buildtune(&tn, &game, game.cat->price, samples);
+
+    int *price = malloc((n + 1) * sizeof(int));
+    memcpy(price, game.cat->price, n * sizeof(int));
+    int **cand = malloc((2 * n + 1) * sizeof(int *));
+    double *cost = malloc((2 * n + 1) * sizeof(double));
+    double *before = malloc((n + 1) * sizeof(double));
+    double *after = malloc((n + 1) * sizeof(double));
+    for (int c = 0; c < 2 * n; c++) {
+        cand[c] = malloc((n + 1) * sizeof(int));
+    }
+
+    double best = committed(&tn, price, before), first = best;
+    long long scored = 1;
+    int step = 400;
+    double start = now();
+    for (int it = 0; it < iterations && step >= 50; it++) {
+        int m = 0;
+        for (int j = 0; j < n; j++) {
+            for (int dir = -1; dir <= 1; dir += 2) {
+                if (price[j] + dir * step < 50) {
+                    continue;
+                }
+                memcpy(cand[m], price, n * sizeof(int));
+                cand[m][j] += dir * step;
+                m++;
+            }
+        }
+        scorebatch(&tn, m, cand, cost);
+        scored += m;
+        int pick = -1;
+        for (int c = 0; c < m; c++) {
+            if (cost[c] < best) {
+                best = cost[c];
+                pick = c;
+            }
+        }
+        if (pick < 0) {
+            step /= 2;
+            step -= step % 50;
+        } else {
+            memcpy(price, cand[pick], n * sizeof(int));
+            retune(&tn, price);
+        }
+    }
+    double secs = now() - start;
+    committed(&tn, price, after);
+
+    printf("|------------|--------|--------|--------|--------|\n");
+    printf("|Weapon Name |Price($)|Win rate|Proposed|Win rate|\n");
+    printf("|------------|--------|--------|--------|--------|\n");
+    for (int r = 0; r < TIERS; r++) {
+        const struct tieR *t = &game.tier[r];
+        for (int k = 0; k < t->count; k++) {
+            int j = t->idx[k];
+            printf("|%-12s|%8d|%7.1f%%|%8d|%7.1f%%|\n", wname(game.cat, j), game.cat->price[j], 100 * before[j],
+                   price[j], 100 * after[j]);
+        }
+        printf("|------------|--------|--------|--------|--------|\n");
+    }
+    printf("Cost %.5f -> %.5f, %lld candidates in %.2f s (%.0f/s)\n", first, best, scored, secs,
+           secs > 0 ? scored / secs : 0);
+
+    int ok = savecase(game.cat, price, file);
+    if (ok == 0) {
+        printf("Proposed catalog written to %s\n", file);
+    } else {
+        printf("%s could not be written\n", file);
+    }
+
+    for (int c = 0; c < 2 * n; c++) {
+        free(cand[c]);
+    }
+    free(cand);
+    free(cost);
+    free(before);
+    free(after);
+    free(price);
+    freetune(&tn);
+    return ok == 0 ? 0 : 1;
+}
+
+//Writes a catalog in the case.txt layout, with price overriding the price column
+int savecase(const struct casE *ptr, const int *price, const char *file){
+
+    FILE *fptr = fopen(file, "w");
+    if (fptr == NULL) {
+        return -1;
+    }
+    for (int j = 0; j < ptr->count; j++) {
+        fprintf(fptr, "%-20s%-10d%-8d%-17g%-15d%-10d%-13.2f%-8.1f%-8s%s\n", wname(ptr, j), price[j], ptr->damage[j],
+                ptr->firerate[j], ptr->magazine[j], ptr->falloff[j], ptr->range[j], ptr->recoil[j],
+                sidename[ptr->side[j] - 1], ptr->tier[j] < TIERS ? tiername[ptr->tier[j]] : "none");
+    }
+    fclose(fptr);
+    return 0;
+}
+
+//Runs fn(arg) on the calling thread and threads - 1 more, returns once all are done
+void runworkers(void *(*fn)(void *), void *arg, int threads){
+
+    pthread_t *tid = malloc((threads + 1) * sizeof(pthread_t));
+    for (int k = 1; k < threads; k++) {
+        pthread_create(&tid[k], NULL, fn, arg);
+    }
+    fn(arg);
+    for (int k = 1; k < threads; k++) {
+        pthread_join(tid[k], NULL);
+    }
+    free(tid);
+}
+
+//Copies the base catalog into every variant, then applies the overrides.
+//Price is not copied: no kernel reads it, so sweep() does not offer it
+void buildbatch(struct batcH *b, const struct gamE *g, int variants, const struct overridE *ov, int n){
+
+    const struct casE *ptr = g->cat;
+    size_t cells = (size_t)ptr->count * variants + 1;
+
+    b->g = g;
+    b->rows = ptr->count;
+    b->variants = variants;
+    b->damage = malloc(cells * sizeof(float));
+    b->firerate = malloc(cells * sizeof(float));
+    b->magazine = malloc(cells * sizeof(float));
+    b->falloff = malloc(cells * sizeof(float));
+    b->range = malloc(cells * sizeof(float));
+    b->recoil = malloc(cells * sizeof(float));
+    b->score = malloc(cells * sizeof(float));
+    b->rate = malloc(cells * sizeof(float));
+    b->fixed = scoring ? malloc(cells * sizeof(long long)) : NULL;
+    for (int j = 0; j < ptr->count; j++) {
+        for (int v = 0; v < variants; v++) {
+            size_t c = (size_t)j * variants + v;
+            b->damage[c] = ptr->damage[j];
+            b->firerate[c] = ptr->firerate[j];
+            b->magazine[c] = ptr->magazine[j];
+            b->falloff[c] = ptr->falloff[j];
+            b->range[c] = ptr->range[j];
+            b->recoil[c] = ptr->recoil[j];
+        }
+    }
+    for (int k = 0; k < n; k++) {
+        size_t c = (size_t)ov[k].row * variants + ov[k].variant;
+        switch (ov[k].col) {
+            case 1: b->damage[c] = (int)ov[k].value; break;
+            case 2: b->firerate[c] = ov[k].value; break;
+            case 3: b->magazine[c] = (int)ov[k].value; break;
+            case 4: b->falloff[c] = (int)ov[k].value; break;
+            case 5: b->range[c] = ov[k].value; break;
+            case 6: b->recoil[c] = ov[k].value; break;
+        }
+    }
+}
+
+//Scores every variant of a tier's rows, then the share of the tier each one beats.
+//The classic formula is float all the way, so the lanes match balanced[] exactly;
+//with fixed scoring every variant goes through fixedscore() and ranks on its integer.
+void *batchworker(void *arg){
+
+    struct batcH *b = arg;
+    int nv = b->variants;
+
+    pthread_mutex_lock(&b->lock);
+    while (b->next < TIERS) {
+        const struct tieR *t = &b->g->tier[b->next++];
+        pthread_mutex_unlock(&b->lock);
+
+        for (int k = 0; k < t->count; k++) {
+            size_t c = (size_t)t->idx[k] * nv;
+            float *s = b->score + c;
+            const float *d = b->damage + c, *f = b->firerate + c, *m = b->magazine + c;
+            const float *fo = b->falloff + c, *r = b->range + c, *rc = b->recoil + c;
+            if (b->fixed != NULL) {
+                long long *x = b->fixed + c;
+                for (int v = 0; v < nv; v++) {
+                    x[v] = fixedscore((int)d[v], f[v], (int)m[v], (int)fo[v], r[v], rc[v], 0);
+                    s[v] = (float)(x[v] / 65536.0);
+                }
+                continue;
+            }
+            for (int v = 0; v < nv; v++) {
+                s[v] = (d[v] * f[v] + m[v] * r[v]) / (fo[v] + rc[v]);
+            }
+        }
+        for (int k = 0; k < t->count; k++) {
+            float *rate = b->rate + (size_t)t->idx[k] * nv;
+            const float *sa = b->score + (size_t)t->idx[k] * nv;
+            for (int v = 0; v < nv; v++) {
+                rate[v] = 0;
+            }
+            for (int o = 0; b->fixed != NULL && o < t->count; o++) {
+                const long long *xa = b->fixed + (size_t)t->idx[k] * nv, *xb = b->fixed + (size_t)t->idx[o] * nv;
+                for (int v = 0; v < nv; v++) {
+                    rate[v] += xa[v] > xb[v];
+                }
+            }
+            for (int o = 0; b->fixed == NULL && o < t->count; o++) {
+                const float *sb = b->score + (size_t)t->idx[o] * nv;
+                for (int v = 0; v < nv; v++) {
+                    rate[v] += sa[v] > sb[v];
+                }
+            }
+            for (int v = 0; v < nv; v++) {
+                rate[v] /= t->count;
+            }
+        }
+
+        pthread_mutex_lock(&b->lock);
+    }
+    pthread_mutex_unlock(&b->lock);
+    return NULL;
+}
+
+//Balance scores and win rates against a uniform pick of the same tier, for every
+//variant in one pass; tiers are shared out between the threads
+void evalbatch(struct batcH *b){
+
+    b->next = 0;
+    pthread_mutex_init(&b->lock, NULL);
+    runworkers(batchworker, b, cores() < TIERS ? cores() : TIERS);
+    pthread_mutex_destroy(&b->lock);
+}
+
+void freebatch(struct batcH *b){
+
+    free(b->damage);
+    free(b->firerate);
+    free(b->magazine);
+    free(b->falloff);
+    free(b->range);
+    free(b->recoil);
+    free(b->score);
+    free(b->rate);
+    free(b->fixed);
+}
+
+//ammo sweep <weapon> <column> <from> <to> [steps]: one variant per step of the column
+int sweep(int argc, char *argv[]){
+
+    if (argc < 6) {
+        printf("Usage: %s sweep <weapon> <column> <from> <to> [steps]\n", argv[0]);
+        return 1;
+    }
+    int row = -1, col = -1;
+    for (int j = 0; j < game.cat->count; j++) {
+        if (strcmp(wname(game.cat, j), argv[2]) == 0) {
+            row = j;
+        }
+    }
+    for (int c = 1; c < COLUMNS - 1; c++) {
+        if (strcmp(columns[c], argv[3]) == 0) {
+            col = c;
+        }
+    }
+    if (row < 0 || col < 0) {
+        printf("Unknown %s %s\n", row < 0 ? "weapon" : "column", row < 0 ? argv[2] : argv[3]);
+        return 1;
+    }
+    //batchworker() only scores tiered rows, a none-tier weapon has nothing to compare with
+    if (game.cat->tier[row] >= TIERS) {
+        printf("%s has no tier\n", argv[2]);
+        return 1;
+    }
+    double from = atof(argv[4]), to = atof(argv[5]);
+    int steps = argc > 6 ? atoi(argv[6]) : 11;
+    if (steps < 2) {
+        steps = 2;
+    }
+
+    struct overridE *ov = malloc(steps * sizeof(struct overridE));
+    for (int v = 0; v < steps; v++) {
+        ov[v] = (struct overridE){v, row, col, from + (to - from) * v / (steps - 1)};
+    }
+    struct batcH b;
+    double start = now();
+    buildbatch(&b, &game, steps, ov, steps);
+    evalbatch(&b);
+    double secs = now() - start;
+
+    printf("|%-10s|Balance|Win rate|\n", columns[col]);
+    printf("|----------|-------|--------|\n");
+    for (int v = 0; v < steps; v++) {
+        size_t c = (size_t)row * steps + v;
+        printf("|%10.2f|%7.1f|%7.1f%%|\n", ov[v].value, b.score[c], 100 * b.rate[c]);
+    }
+    printf("%d variants in %.3f ms\n", steps, secs * 1000);
+
+    freebatch(&b);
+    free(ov);
+    return 0;
+}
+
+//Frees what buildgame() allocated for a game
+void freegame(struct gamE *g){
+
+    for (int r = 0; r < TIERS; r++) {
+        freetier(&g->tier[r]);
+    }
+    for (int p = 0; p < g->pools && g->pool != NULL; p++) {
+        freetier(&g->pool[p]);
+        for (int s = 0; s < 2; s++) {
+            freetier(&g->sides[s][p]);
+            free(g->share[s][p].prob);
+            free(g->share[s][p].alias);
+            free(g->share[s][p].weight);
+        }
+        free(g->matchup[p]);
+    }
+    free(g->pool);
+    free(g->matchup);
+    for (int s = 0; s < 2; s++) {
+        free(g->sides[s]);
+        free(g->share[s]);
+        g->sides[s] = NULL;
+        g->share[s] = NULL;
+    }
+    free(g->kill);
+    g->kill = NULL;
+    g->pool = NULL;
+    g->matchup = NULL;
+    g->pools = 0;
+    memset(g->tier, 0, sizeof(g->tier));
+}
+
+void freetier(struct tieR *t){
+
+    free(t->idx);
+    free(t->byprice);
+    free(t->price);
+    free(t->best);
+    free(t->brk);
+    free(t->afford);
+}
+
+//Classic balance score of row j with one column (1 damage ... 6 recoil) replaced
+double rowscore(const struct casE *ptr, int j, int col, double value){
+
+    int damage = col == 1 ? (int)value : ptr->damage[j];
+    float firerate = col == 2 ? (float)value : ptr->firerate[j];
+    int magazine = col == 3 ? (int)value : ptr->magazine[j];
+    int falloff = col == 4 ? (int)value : ptr->falloff[j];
+    float range = col == 5 ? (float)value : ptr->range[j];
+    float recoil = col == 6 ? (float)value : ptr->recoil[j];
+    if (scoring == 1) {
+        return fixedscore(damage, firerate, magazine, falloff, range, recoil, 0) / 65536.0;
+    }
+    return ((damage * firerate) + (magazine * range)) / (float)(falloff + recoil);
+}
+
+//Round win rate of a row over the job's matches; every game replays the same seeds
+double weaponrate(const struct gamE *g, const struct sensjoB *job, int row, struct tallY *tally){
+
+    memset(tally->picked, 0, g->cat->count * sizeof(long long));
+    memset(tally->won, 0, g->cat->count * sizeof(long long));
+    for (long long i = 0; i < job->matches; i++) {
+        struct rnG rng = {job->seed + (unsigned long long)i * 0xd1b54a32d192ed03ULL, 0};
+        seatmatch(g, job->a, job->b, i, &rng, tally);
+    }
+    return tally->picked[row] ? (double)tally->won[row] / tally->picked[row] : 0;
+}
+
+void *sensworker(void *arg){
+
+    pooled = 1;
+    struct sensjoB *job = arg;
+    const struct casE *ptr = job->g->cat;
+    int n = ptr->count;
+    struct tallY tally = {malloc((n + 1) * sizeof(long long)), malloc((n + 1) * sizeof(long long))};
+    struct gamE v[2];
+    memset(v, 0, sizeof(v));
+    for (int s = 0; s < 2; s++) {
+        v[s].cat = job->g->cat;
+        v[s].eco = job->g->eco;
+        v[s].score = malloc((n + 1) * sizeof(double));
+    }
+
+    pthread_mutex_lock(&job->lock);
+    while (job->next < job->n) {
+        struct sensE *e = &job->out[job->next++];
+        pthread_mutex_unlock(&job->lock);
+
+        int j = e->row, integer = e->col == 1 || e->col == 3 || e->col == 4;
+        double x = column((struct casE *)ptr, e->col, j), lo = x * 0.95, hi = x * 1.05;
+        if (integer) {
+            lo = floor(lo) < x - 1 ? floor(lo) : x - 1;
+            hi = ceil(hi) > x + 1 ? ceil(hi) : x + 1;
+            if (lo < 0) lo = 0;
+        }
+
+        //d ln S / d ln x of S = (d f + m r) / (fo + rc)
+        double top = ptr->damage[j] * ptr->firerate[j] + ptr->magazine[j] * ptr->range[j];
+        double bottom = ptr->falloff[j] + ptr->recoil[j];
+        double part = 0;
+        switch (e->col) {
+            case 1: part = ptr->firerate[j] / bottom; break;
+            case 2: part = ptr->damage[j] / bottom; break;
+            case 3: part = ptr->range[j] / bottom; break;
+            case 4: case 6: part = -top / (bottom * bottom); break;
+            case 5: part = ptr->magazine[j] / bottom; break;
+        }
+        e->elastic = part * x / job->g->score[j];
+
+        //Central difference on the round win rate, both sides on the same streams
+        double rate[2];
+        for (int s = 0; s < 2; s++) {
+            memcpy(v[s].score, job->g->score, n * sizeof(double));
+            v[s].score[j] = rowscore(ptr, j, e->col, s ? hi : lo);
+            buildgame(&v[s]);
+            rate[s] = weaponrate(&v[s], job, j, &tally);
+        }
+        e->winrate = job->base[j];
+        e->slope = x > 0 ? (rate[1] - rate[0]) / ((hi - lo) / x) : rate[1] - rate[0];
+
+        pthread_mutex_lock(&job->lock);
+    }
+    pthread_mutex_unlock(&job->lock);
+
+    for (int s = 0; s < 2; s++) {
+        freegame(&v[s]);
+        free(v[s].score);
+    }
+    free(tally.picked);
+    free(tally.won);
+    pooled = 0;
+    return NULL;
+}
+
+//Larger win-rate effect first
+int bylever(const void *a, const void *b){
+
+    double x = fabs(((const struct sensE *)a)->slope), y = fabs(((const struct sensE *)b)->slope);
+    return (x < y) - (x > y);
+}
+
+//ammo sensitivity [matches] [bot] [bot]: every weapon and stat in parallel, ranked by
+//how much a 1% change of the stat moves the weapon's round win rate
+int sensitivity(int argc, char *argv[]){
+
+    static struct sensjoB job;
+    int stats = 6, n = game.cat->count;
+
+    job.g = &game;
+    job.matches = argc > 2 ? atoll(argv[2]) : 20000;
+    job.a = findbot(argc > 3 ? argv[3] : "random");
+    job.b = findbot(argc > 4 ? argv[4] : "random");
+    if (job.a == NULL || job.b == NULL) {
+        printf("Unknown bot\n");
+        return 1;
+    }
+    job.seed = (unsigned long long)time(NULL);
+    job.n = n * stats;
+    job.out = malloc((job.n + 1) * sizeof(struct sensE));
+    for (int j = 0; j < n; j++) {
+        for (int s = 0; s < stats; s++) {
+            job.out[j * stats + s] = (struct sensE){j, s + 1, 0, 0, 0};
+        }
+    }
+    job.next = 0;
+    pthread_mutex_init(&job.lock, NULL);
+    double start = now();
+    //The base rates do not depend on the stat, the tally of one run holds every row's
+    struct tallY tally = {malloc((n + 1) * sizeof(long long)), malloc((n + 1) * sizeof(long long))};
+    job.base = malloc((n + 1) * sizeof(double));
+    weaponrate(&game, &job, 0, &tally);
+    for (int j = 0; j < n; j++) {
+        job.base[j] = tally.picked[j] ? (double)tally.won[j] / tally.picked[j] : 0;
+    }
+    free(tally.picked);
+    free(tally.won);
+    runworkers(sensworker, &job, cores());
+    double secs = now() - start;
+    pthread_mutex_destroy(&job.lock);
+
+    //Per weapon, stats by the size of their effect on the win rate
+    printf("|------------|--------|------------------------------------------------------------------------------|\n");
+    printf("|Weapon Name |Win rate|%-78s|\n", "Stats by win-rate change per +1% (balance score change)");
+    printf("|------------|--------|------------------------------------------------------------------------------|\n");
+    for (int j = 0; j < n; j++) {
+        struct sensE *e = job.out + j * stats;
+        qsort(e, stats, sizeof(struct sensE), bylever);
+        char line[256];
+        int len = 0;
+        for (int s = 0; s < 3; s++) {
+            len += snprintf(line + len, sizeof(line) - len, "%s %+.2f%% (%+.2f%%)  ", columns[e[s].col],
+                            e[s].slope, e[s].elastic);
+        }
+        printf("|%-12s|%7.1f%%|%-78s|\n", wname(game.cat, j), 100 * e[0].winrate, line);
+    }
+    printf("|------------|--------|------------------------------------------------------------------------------|\n");
+
+    //Strongest levers over the whole catalog
+    struct sensE *all = malloc((job.n + 1) * sizeof(struct sensE));
+    memcpy(all, job.out, job.n * sizeof(struct sensE));
+    qsort(all, job.n, sizeof(struct sensE), bylever);
+    printf("\nStrongest levers:\n");
+    for (int k = 0; k < 10 && k < job.n; k++) {
+        printf("%2d. %-12s %-9s %+.2f%% win rate per +1%%\n", k + 1, wname(game.cat, all[k].row),
+               columns[all[k].col], all[k].slope);
+    }
+    printf("%d weapon/stat pairs in %.2f s\n", job.n, secs);
+
+    free(all);
+    free(job.base);
+    free(job.out);
+    return 0;
+}
+
+int gcd(int a, int b){
+
+    while (b != 0) {
+        int t = a % b;
+        a = b;
+        b = t;
+    }
+    return a;
+}
+
+//Balance at the start of the round after this one from what is left unspent, counting
+//the smaller of the win reward and the first loss bonus as the only sure reward
+int plannext(const struct gamE *g, int round, int balance){
+
+    const struct ecoN *e = g->eco;
+    if (round + 1 >= g->rounds) {
+        return 0;
+    }
+    int sure = roundtier(g, round)->count > 0 ? (e->win < e->loss[0] ? e->win : e->loss[0]) : 0;
+    int next = (balance + sure) * e->carry / 100 + roundincome(g, round + 1);
+    return e->cap > 0 && next > e->cap ? e->cap : next;
+}
+
+//Plan of a side (0 T, 1 CT), recomputed only when the catalog version changed
+const struct plaN *getplan(const struct gamE *g, int side){
+
+    unsigned long long hash = cataloghash(g);
+    struct plaN *p = &plan[side];
+    if (p->valid && p->hash == hash) {
+        return p;
+    }
+
+    //Frontier: one sweep along the price order, keeping rows that beat every cheaper one
+    int unit = 0, top = 0;
+    for (int r = g->pools; r < p->pools; r++) {
+        free(p->front[r]);
+    }
+    p->front = realloc(p->front, g->pools * sizeof(*p->front));
+    p->fronts = realloc(p->fronts, g->pools * sizeof(int));
+    for (int r = p->pools; r < g->pools; r++) {
+        p->front[r] = NULL;
+    }
+    p->pools = g->pools;
+    for (int r = 0; r < g->pools; r++) {
+        const struct tieR *t = &g->sides[side][r];
+        p->front[r] = realloc(p->front[r], (t->count + 1) * sizeof(int));
+        p->fronts[r] = 0;
+        double best = -1;
+        for (int k = 0; k < t->count; k++) {
+            int j = t->byprice[k];
+            //Only the best of rows sharing a price can be on the frontier
+            int e = k;
+            while (e + 1 < t->count && t->price[e + 1] == t->price[k]) {
+                e++;
+                if (g->score[t->byprice[e]] > g->score[j]) j = t->byprice[e];
+            }
+            if (g->score[j] > best) {
+                best = g->score[j];
+                p->front[r][p->fronts[r]++] = j;
+            }
+            unit = gcd(unit, t->price[k]);
+            k = e;
+        }
+    }
+    //Income and rewards keep balances on the unit grid, only a partial carry rounds down
+    const struct ecoN *eco = g->eco;
+    unit = gcd(gcd(unit, eco->start), gcd(eco->win, eco->loss[0]));
+    for (int r = 0; r < g->rounds; r++) {
+        unit = gcd(unit, roundincome(g, r));
+    }
+    //The richest a side can be is when it never buys
+    for (int r = 0, b = eco->start + roundincome(g, 0); r < g->rounds; b = plannext(g, r++, b)) {
+        if (b > top) top = b;
+    }
+    if (unit == 0) {
+        unit = 1;
+    }
+
+    //Backwards over the rounds; only frontier rows can be worth their price, and each
+    //one wins against a uniform pick of the other side's pool as often as it beats a row of it
+    int states = top / unit + 1;
+    p->unit = unit;
+    p->states = states;
+    p->rounds = g->rounds;
+    p->value = realloc(p->value, (size_t)(g->rounds + 1) * states * sizeof(double));
+    p->choice = realloc(p->choice, (size_t)g->rounds * states * sizeof(int));
+    for (int s = 0; s < states; s++) {
+        p->value[(size_t)g->rounds * states + s] = 0;
+    }
+    double *win = malloc((g->cat->count + 1) * sizeof(double));
+    for (int r = g->rounds - 1; r >= 0; r--) {
+        int pool = g->draw[r];
+        const struct tieR *t = &g->sides[side][pool];
+        int others = g->sides[1 - side][pool].count;
+        for (int k = 0; k < t->count; k++) {
+            win[t->idx[k]] = others > 0 ? g->share[side][pool].weight[k] / others : 0;
+        }
+        const double *later = p->value + (size_t)(r + 1) * states;
+        for (int s = 0; s < states; s++) {
+            int after = plannext(g, r, s * unit) / unit;
+            double best = later[after < states ? after : states - 1];
+            int pick = -1;
+            for (int f = 0; f < p->fronts[pool]; f++) {
+                int j = p->front[pool][f], cost = g->cat->price[j] / unit;
+                if (cost > s) {
+                    break;
+                }
+                after = plannext(g, r, (s - cost) * unit) / unit;
+                if (after >= states) after = states - 1;
+                if (win[j] + later[after] > best) {
+                    best = win[j] + later[after];
+                    pick = j;
+                }
+            }
+            p->value[(size_t)r * states + s] = best;
+            p->choice[(size_t)r * states + s] = pick;
+        }
+    }
+    free(win);
+
+    p->hash = hash;
+    p->valid = 1;
+    return p;
+}
+
+//Row the plan buys in a round with the given balance, -1 for nothing
+int planned(const struct plaN *p, int round, int balance){
+
+    int s = balance / p->unit;
+    if (s >= p->states) {
+        s = p->states - 1;
+    }
+    return p->choice[(size_t)round * p->states + s];
+}
+
+//ammo plan [balance] [T|CT]: frontiers of every pool and the best buy sequence of a
+//side from a balance
+int planner(int argc, char *argv[]){
+
+    int side = argc > 3 && findside(argv[3]) == 2 ? 1 : 0;
+    const struct plaN *p = getplan(&game, side);
+    int blnc = argc > 2 ? atoi(argv[2]) : game.eco->start + roundincome(&game, 0);
+
+    for (int r = 0; r < game.pools; r++) {
+        printf("%-7s frontier:", sched.name[r]);
+        for (int f = 0; f < p->fronts[r]; f++) {
+            int j = p->front[r][f];
+            printf(" %s ($%d, %.1f)", wname(game.cat, j), game.cat->price[j], game.score[j]);
+        }
+        printf("\n");
+    }
+
+    printf("\n%s buy plan from $%d:\n", sidename[side], blnc);
+    double expect = p->value[blnc / p->unit < p->states ? blnc / p->unit : p->states - 1];
+    for (int r = 0; r < game.rounds; r++) {
+        int j = planned(p, r, blnc);
+        printf("Round %d: $%-6d %s\n", r + 1, blnc, wname(game.cat, j));
+        blnc = plannext(&game, r, blnc - (j < 0 ? 0 : game.cat->price[j]));
+    }
+    printf("Expected rounds won against uniform picks: %.2f of %d\n", expect, game.rounds);
+    return 0;
+}
+
+//Largest power of two scale, within 2^-16..2^16, that keeps max at or under top
+int qshift(double max, int top){
+
+    int shift = 16;
+    while (shift > -16 && ldexp(max, shift) > top) {
+        shift--;
+    }
+    return shift;
+}
+
+//Rounds every stat of the catalog onto its column's grid, -1 without memory for it
+int quantize(const struct casE *ptr, struct quanT *q){
+
+    int n = ptr->count;
+    double max[STATS] = {0};
+    for (int j = 0; j < n; j++) {
+        for (int c = 0; c < STATS; c++) {
+            if (column((struct casE *)ptr, c, j) > max[c]) max[c] = column((struct casE *)ptr, c, j);
+        }
+    }
+    for (int c = 0; c < STATS; c++) {
+        q->shift[c] = qshift(max[c], (1 << 8 * statbytes[c]) - 1);
+    }
+    freequant(q);
+    q->count = n;
+    int ok = regrow(&q->price, 0, (n + 1) * sizeof(unsigned short)) == 0;
+    ok = ok && regrow(&q->damage, 0, n + 1) == 0;
+    ok = ok && regrow(&q->firerate, 0, (n + 1) * sizeof(unsigned short)) == 0;
+    ok = ok && regrow(&q->magazine, 0, n + 1) == 0;
+    ok = ok && regrow(&q->falloff, 0, n + 1) == 0;
+    ok = ok && regrow(&q->range, 0, (n + 1) * sizeof(unsigned short)) == 0;
+    ok = ok && regrow(&q->recoil, 0, (n + 1) * sizeof(unsigned short)) == 0;
+    if (!ok) {
+        freequant(q);
+        q->count = 0;
+        return -1;
+    }
+    for (int j = 0; j < n; j++) {
+        long v[STATS];
+        for (int c = 0; c < STATS; c++) {
+            v[c] = lround(ldexp(column((struct casE *)ptr, c, j), q->shift[c]));
+            if (v[c] < 0) v[c] = 0;
+            if (v[c] > (1 << 8 * statbytes[c]) - 1) v[c] = (1 << 8 * statbytes[c]) - 1;
+        }
+        q->price[j] = (unsigned short)v[0];
+        q->damage[j] = (unsigned char)v[1];
+        q->firerate[j] = (unsigned short)v[2];
+        q->magazine[j] = (unsigned char)v[3];
+        q->falloff[j] = (unsigned char)v[4];
+        q->range[j] = (unsigned short)v[5];
+        q->recoil[j] = (unsigned short)v[6];
+    }
+    return 0;
+}
+
+double qvalue(const struct quanT *q, int c, int j){
+
+    switch (c) {
+        case 0: return ldexp(q->price[j], -q->shift[0]);
+        case 1: return ldexp(q->damage[j], -q->shift[1]);
+        case 2: return ldexp(q->firerate[j], -q->shift[2]);
+        case 3: return ldexp(q->magazine[j], -q->shift[3]);
+        case 4: return ldexp(q->falloff[j], -q->shift[4]);
+        case 5: return ldexp(q->range[j], -q->shift[5]);
+        default: return ldexp(q->recoil[j], -q->shift[6]);
+    }
+}
+
+//The catalog as the quantized columns hold it: ptr's names, sides and tiers with every
+//stat column decoded from q into arrays of its own
+void dequantize(const struct quanT *q, const struct casE *ptr, struct casE *out){
+
+    int n = q->count;
+    *out = *ptr;
+    out->price = malloc((n + 1) * sizeof(int));
+    out->damage = malloc((n + 1) * sizeof(int));
+    out->firerate = malloc((n + 1) * sizeof(float));
+    out->magazine = malloc((n + 1) * sizeof(int));
+    out->falloff = malloc((n + 1) * sizeof(int));
+    out->range = malloc((n + 1) * sizeof(float));
+    out->recoil = malloc((n + 1) * sizeof(float));
+    for (int j = 0; j < n; j++) {
+        out->price[j] = (int)lround(qvalue(q, 0, j));
+        out->damage[j] = (int)lround(qvalue(q, 1, j));
+        out->firerate[j] = (float)qvalue(q, 2, j);
+        out->magazine[j] = (int)lround(qvalue(q, 3, j));
+        out->falloff[j] = (int)lround(qvalue(q, 4, j));
+        out->range[j] = (float)qvalue(q, 5, j);
+        out->recoil[j] = (float)qvalue(q, 6, j);
+    }
+}
+
+//Classic balance score straight from the integer columns. Each product or sum is
+//scaled once by the power of two its operands carry.
+void qscore(const struct quanT *q, double *out){
+
+    const float dps = ldexpf(1, -(q->shift[1] + q->shift[2]));
+    const float hold = ldexpf(1, -(q->shift[3] + q->shift[5]));
+    const float fall = ldexpf(1, -q->shift[4]), kick = ldexpf(1, -q->shift[6]);
+    for (int i = 0; i < q->count; i++) {
+        out[i] = ((float)q->damage[i] * q->firerate[i] * dps + (float)q->magazine[i] * q->range[i] * hold) \
+        / (q->falloff[i] * fall + q->recoil[i] * kick);
+    }
+}
+
+void freequant(struct quanT *q){
+
+    free(q->price);
+    free(q->damage);
+    free(q->firerate);
+    free(q->magazine);
+    free(q->falloff);
+    free(q->range);
+    free(q->recoil);
+    q->price = NULL;
+    q->damage = NULL;
+    q->firerate = NULL;
+    q->magazine = NULL;
+    q->falloff = NULL;
+    q->range = NULL;
+    q->recoil = NULL;
+}
+
+void *parityworker(void *arg){
+
+    pooled = 1;
+    struct paritY *job = arg;
+    const long long batch = 4096;
+
+    pthread_mutex_lock(&job->lock);
+    while (job->next * batch < job->matches) {
+        long long first = job->next++ * batch;
+        pthread_mutex_unlock(&job->lock);
+
+        long long last = first + batch < job->matches ? first + batch : job->matches;
+        long long flips = 0, wins[2] = {0, 0};
+        for (long long i = first; i < last; i++) {
+            int w[2];
+            for (int v = 0; v < 2; v++) {
+                struct rnG rng = {job->seed + (unsigned long long)i * 0xd1b54a32d192ed03ULL, 0};
+                w[v] = seatmatch(job->g[v], job->a, job->b, i, &rng, NULL);
+                wins[v] += w[v] == 0;
+            }
+            flips += w[0] != w[1];
+        }
+
+        pthread_mutex_lock(&job->lock);
+        job->flips += flips;
+        job->wins[0] += wins[0];
+        job->wins[1] += wins[1];
+    }
+    pthread_mutex_unlock(&job->lock);
+    pooled = 0;
+    return NULL;
+}
+
+//ammo parity [matches] [bot] [bot]: checks the quantized catalog against the float one.
+//Scores must agree within TOLERANCE and no two rows of a pool further apart than that
+//may change order; the matches show how many results the quantized game changes.
+int parity(int argc, char *argv[]){
+
+    static struct quanT q;
+    static struct casE packed;
+    static struct gamE variant;
+    static struct paritY job;
+    int n = ammo.count;
+
+    //The quantized game charges the decoded prices and ranks by the integer scores
+    if (quantize(&ammo, &q) < 0) {
+        printf("Out of memory for the compact catalog\n");
+        return 1;
+    }
+    dequantize(&q, &ammo, &packed);
+    variant.cat = &packed;
+    variant.eco = game.eco;
+    variant.score = malloc((n + 1) * sizeof(double));
+    qscore(&q, variant.score);
+    buildgame(&variant);
+
+    printf("|Column    |Shift|Bytes|Max error |\n");
+    printf("|----------|-----|-----|----------|\n");
+    int bytes = 0;
+    for (int c = 0; c < STATS; c++) {
+        double worst = 0;
+        for (int j = 0; j < n; j++) {
+            double e = fabs(qvalue(&q, c, j) - column(&ammo, c, j));
+            if (e > worst) worst = e;
+        }
+        printf("|%-10s|%5d|%5d|%10.6f|\n", columns[c], q.shift[c], statbytes[c], worst);
+        bytes += statbytes[c];
+    }
+    printf("|----------|-----|-----|----------|\n");
+    printf("Row size: %d bytes quantized, %d bytes float\n", bytes, (int)(4 * STATS));
+
+    double worst = 0;
+    int row = 0;
+    for (int j = 0; j < n; j++) {
+        double e = fabs(variant.score[j] - balanced[j]) / (balanced[j] > 0 ? balanced[j] : 1);
+        if (e > worst) {
+            worst = e;
+            row = j;
+        }
+    }
+    printf("Balance score: max relative error %.2e (%s), tolerance %.2e\n", worst, wname(&ammo, row), TOLERANCE);
+    int moved = 0;
+    for (int j = 0; j < n; j++) {
+        moved += packed.price[j] != ammo.price[j];
+    }
+    printf("Prices: %d of %d change in the quantized game\n", moved, n);
+
+    //Orders inside a pool decide every round, near ties may swap within the tolerance
+    int flips = 0, bad = 0;
+    for (int p = 0; p < game.pools; p++) {
+        const struct tieR *t = &game.pool[p];
+        for (int a = 0; a < t->count; a++) {
+            for (int b = a + 1; b < t->count; b++) {
+                int x = t->idx[a], y = t->idx[b];
+                double d = balanced[x] - balanced[y], e = variant.score[x] - variant.score[y];
+                if ((d > 0) != (e > 0) || (d < 0) != (e < 0)) {
+                    flips++;
+                    bad += fabs(d) > 2 * TOLERANCE * fmax(balanced[x], balanced[y]);
+                }
+            }
+        }
+    }
+    printf("Round outcomes: %d of the pool pairs flip, %d beyond the tolerance\n", flips, bad);
+
+    job.g[0] = &game;
+    job.g[1] = &variant;
+    job.matches = argc > 2 ? atoll(argv[2]) : 100000;
+    job.a = findbot(argc > 3 ? argv[3] : "equilibrium");
+    job.b = findbot(argc > 4 ? argv[4] : "random");
+    if (job.a == NULL || job.b == NULL) {
+        printf("Unknown bot %s\n", job.a == NULL ? argv[3] : argv[4]);
+        return 1;
+    }
+    job.seed = 0x5eedULL;
+    pthread_mutex_init(&job.lock, NULL);
+    runworkers(parityworker, &job, cores());
+    pthread_mutex_destroy(&job.lock);
+    printf("%s vs %s, %lld matches: %.2f%% float, %.2f%% quantized, %lld results differ\n", job.a->name,
+           job.b->name, job.matches, 100.0 * job.wins[0] / job.matches, 100.0 * job.wins[1] / job.matches, job.flips);
+
+    int ok = worst <= TOLERANCE && bad == 0;
+    printf("%s\n", ok ? "Parity holds" : "Parity broken");
+    freegame(&variant);
+    free(variant.score);
+    free(packed.price);
+    free(packed.damage);
+    free(packed.firerate);
+    free(packed.magazine);
+    free(packed.falloff);
+    free(packed.range);
+    free(packed.recoil);
+    freequant(&q);
+    return ok ? 0 : 1;
+}
+
+//Asks for a weapon of the tier until an affordable one is chosen, returns its row
+int askweapon(const struct tieR *t, int budget){
+
+    int slctw;
+
+    printf("Please Select your weapon: ");
+    scanf("%d",&slctw);
+    //Prevent possible errors
+    while (1 == 1){
+        if (slctw < 1 || slctw > t->count) {
+            printf("An invalid number was entered\n");
+            printf("Please Select your weapon: ");
+            scanf("%d",&slctw);
+        } else if(!canafford(t, slctw-1, budget)){
+            printf("Your money isn't enough\n");
+            printf("Please Select your weapon: ");
+            scanf("%d",&slctw);
+        }
+        else {
+            break;
+        }
+    }
+    return t->idx[slctw-1];
+}
+
+void play(struct casE *ptr){
+
+    int chs,wp,randnum;
+    struct matcH m;
+    struct rounD r;
+    struct rnG rng = {(unsigned long long)time(NULL), 0};
+    struct tapE tape;
+    int pick[2], blnc[2];
+    unsigned long long seed = rng.s;
+    
+    printf("Welcome the FireSync\n1) T: \n2) CT: \nPlease select your team: ");
+    scanf("%d",&chs);
+    //You play seat 0, choosing CT only swaps which side's tiers each seat reads
+    game.seat[0] = chs == 2;
+    game.seat[1] = chs != 2;
+    tapebegin(&tape, arenaalloc(&arena, tapebound(1, game.rounds)), 1, game.seat[0]);
+    newmatch(&game, &m);
+    while (m.round < game.rounds){
+        const struct tieR *t = seattier(&game, 0, m.round);
+        blnc[0] = m.blnc[0];
+        blnc[1] = m.blnc[1];
+        if (roundtier(&game, m.round)->count == 0) {
+            pick[0] = pick[1] = -1;
+            resolve(&game, &m, -1, -1);
+            taperound(&tape, pick, blnc, 2);
+            continue;
+        }
+        printf("Your Balance (Round %d): $%d\n",m.round + 1,m.blnc[0]);
+        printf("Enemy Balance: $%d\n",m.blnc[1]);
+        for (int k = 0; k < t->count; k++){
+            printf("%d) %s $%d\n",k + 1,wname(ptr, t->idx[k]),ptr->price[t->idx[k]]);
+        }
+        wp = bestbuy(t, m.blnc[0]);
+        if (wp < 0) {
+            printf("Your money isn't enough for any weapon\n");
+        } else {
+            printf("Best weapon you can afford: %s\n",wname(ptr, wp));
+            printf("Planned buy for the whole match: %s\n",wname(ptr, planned(getplan(&game, game.seat[0]), m.round, m.blnc[0])));
+            wp = askweapon(t, m.blnc[0]);
+        }
+        //Weapon selection part of the bot
+        botview(&game, &m, 1, &r);
+        randnum = enemybot->pick(enemybot, &r, &rng);
+        printf("Your Weapon is %s \nEnemy Weapon is %s",wname(ptr, wp),wname(ptr, randnum));
+        usleep(1000000);
+        //Balance reduction and the result of the round
+        pick[0] = wp;
+        pick[1] = randnum;
+        int win = resolve(&game, &m, wp, randnum);
+        taperound(&tape, pick, blnc, win);
+        if (win == 0){
+            printf("\nYou win\n");
+        } else {
+            printf("\nYou lose\n");
+        }
+        printf("Score Table : %d %d\n",m.score[0],m.score[1]);
+    }
+    logplay(&tape, 1, seed);
+    game.seat[0] = 0;
+    game.seat[1] = 1;
+    arenareset(&arena);
+}
+
+//5v5 game: you are player 1 of your side, your teammates and the enemy team are
+//played by the enemy bot
+void teamplay(struct casE *ptr){
+
+    int chs,wp;
+    struct teaM m;
+    struct rounD r;
+    struct rnG rng = {(unsigned long long)time(NULL), 0};
+    int buy[2][TEAM], kills[2][TEAM], blnc[2 * TEAM];
+    struct tapE tape;
+    unsigned long long seed = rng.s;
+
+    printf("Welcome the FireSync\n1) T: \n2) CT: \nPlease select your team: ");
+    scanf("%d",&chs);
+    game.seat[0] = chs == 2;
+    game.seat[1] = chs != 2;
+    const char *side[2] = {sidename[game.seat[0]], sidename[game.seat[1]]};
+    tapebegin(&tape, arenaalloc(&arena, tapebound(TEAM, game.rounds)), TEAM, game.seat[0]);
+    newteam(&game, &m);
+    while (m.round < game.rounds){
+        const struct tieR *t = seattier(&game, 0, m.round);
+        memcpy(blnc, m.blnc, sizeof(blnc));
+        for (int s = 0; s < 2; s++) {
+            for (int p = 0; p < TEAM; p++) {
+                teamview(&game, &m, s, p, &r);
+                buy[s][p] = roundtier(&game, m.round)->count == 0 ? -1 : enemybot->pick(enemybot, &r, &rng);
+            }
+        }
+        if (roundtier(&game, m.round)->count == 0) {
+            teamround(&game, &m, buy, &rng, NULL);
+            taperound(&tape, &buy[0][0], blnc, 2);
+            continue;
+        }
+        printf("Your Balance (Round %d): $%d\n",m.round + 1,m.blnc[0][0]);
+        printf("Team Balances:");
+        for (int p = 1; p < TEAM; p++) {
+            printf(" $%d",m.blnc[0][p]);
+        }
+        printf("\n");
+        for (int k = 0; k < t->count; k++){
+            printf("%d) %s $%d\n",k + 1,wname(ptr, t->idx[k]),ptr->price[t->idx[k]]);
+        }
+        wp = bestbuy(t, m.blnc[0][0]);
+        if (wp < 0) {
+            printf("Your money isn't enough for any weapon\n");
+        } else {
+            printf("Best weapon you can afford: %s\n",wname(ptr, wp));
+            wp = askweapon(t, m.blnc[0][0]);
+        }
+        buy[0][0] = wp;
+        int win = teamround(&game, &m, buy, &rng, kills);
+        taperound(&tape, &buy[0][0], blnc, win);
+        for (int s = 0; s < 2; s++) {
+            for (int p = 0; p < TEAM; p++) {
+                printf("%-2s %d: %-12s %d kills\n",side[s],p + 1,wname(ptr, buy[s][p]),kills[s][p]);
+            }
+        }
+        usleep(1000000);
+        if (win == 0){
+            printf("\n%s win\n",side[0]);
+        } else {
+            printf("\n%s win\n",side[1]);
         }
+        printf("Score Table : %d %d\n",m.score[0],m.score[1]);
     }
+    logplay(&tape, TEAM, seed);
+    game.seat[0] = 0;
+    game.seat[1] = 1;
+    arenareset(&arena);
 }
 
 // Ref
@@ -0,0 +1,23 @@
+#!/bin/sh
+#A two-bot league must put the bots elogap(score) apart: 400 log10(s / (1 - s))
+#with the score clamped to [0.001, 0.999], and a checkpoint with a pairing out of range
+#must not be resumed. Usage: tests/league.sh [path to ammo]
+ammo=${1:-./ammo}
+file=$(mktemp)
+rm -f "$file"
+"$ammo" league "$file" greedy random --games 4000 > /dev/null || exit 1
+awk 'NR == 2 { a = $2 } NR == 3 { b = $2 }
+     NR == 4 { s = $4 / $3; if (s < 0.001) s = 0.001; if (s > 0.999) s = 0.999
+               want = 400 * log(s / (1 - s)) / log(10)
+               printf "score %.4f, rating gap %.3f, elogap %.3f\n", s, a - b, want
+               exit (a - b - want > 0.01 || want - (a - b) > 0.01) }' "$file"
+status=$?
+#A checkpoint whose pairing names a bot the league does not have must be rejected
+if [ $status -eq 0 ]; then
+    sed -i '4s/^0 1 /0 7 /' "$file"
+    "$ammo" league "$file" greedy random --games 10 | grep -q "not a checkpoint of this league"
+    status=$?
+fi
+rm -f "$file"
+[ $status -eq 0 ] && echo "league: ok" || echo "league: FAILED"
+exit $status
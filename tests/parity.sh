@@ -0,0 +1,11 @@
+#!/bin/sh
+#The compact catalog must score every weapon within 2^-10 of the float one, keep the
+#order of every pool pair further apart than that and change no match result.
+#Usage: tests/parity.sh [path to ammo]
+ammo=${1:-./ammo}
+out=$("$ammo" parity 20000)
+status=$?
+echo "$out" | grep -E "max relative error|pool pairs flip|results differ"
+echo "$out" | grep -q " 0 results differ" || status=1
+[ $status -eq 0 ] && echo "parity: ok" || echo "parity: FAILED"
+exit $status